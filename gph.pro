@@ -3,15 +3,19 @@ CONFIG 		+= qt
 DESTDIR 	= bin
 OBJECTS_DIR     = .tmp
 LIBS 		= -L/usr/lib/graphviz -lcgraph -lpathplan -lcdt -lgvplugin_dot_layout
+LIBS            += -lpng
 LIBS            += "-LC:/Program Files (x86)/Graphviz2.38/lib/release/lib/" -lgvc
 LIBS += -L$$PWD/../../Downloads/boost_1_57_0/bin.v2/libs/filesystem/build/gcc-mingw-4.9.2/release/link-static/threading-multi/ -lboost_filesystem-mgw49-mt-1_57
 LIBS += -L$$PWD/../../Downloads/boost_1_57_0/bin.v2/libs/system/build/gcc-mingw-4.9.2/release/link-static/threading-multi/ -lboost_system-mgw49-mt-1_57
 
 HEADERS 	= 	headers/Action.h 		\
+                        headers/ActionRouter.h		\
                         headers/Exceptions.h 	\
                         headers/IO.h 			\
                         headers/GProcess.h 		\
                         headers/GAction.h 		\
+                        headers/GActionLayer.h		\
+                        headers/GLabelItem.h		\
                         headers/GSort.h 		\
                         headers/GVEdge.h 		\
                         headers/GVNode.h	 	\
@@ -20,8 +24,10 @@ HEADERS 	= 	headers/Action.h 		\
                         headers/PH.h 			\
                         headers/PHScene.h		\
                         headers/PHIO.h 			\
+                        headers/PNGWriter.h		\
                         headers/Process.h 		\
                         headers/Sort.h \
+                        headers/SortIndex.h \
                         headers/Area.h \
                         headers/TextArea.h \
                         headers/TreeArea.h \
@@ -35,7 +41,12 @@ HEADERS 	= 	headers/Action.h 		\
                         headers/FuncFrame.h \
                         headers/FunctionForm.h \
                         headers/test/ChoixLigne.h \
+                        headers/ForceLayout.h \
+                        headers/GVLayoutCache.h \
+                        headers/GVLayoutService.h \
                         headers/GVSkeletonGraph.h \
+                        headers/LayoutStrategy.h \
+                        headers/LevelOfDetail.h \
                         headers/TikzEditor.h
 
 INCLUDEPATH = headers headers/axe headers/test
@@ -45,13 +56,23 @@ INCLUDEPATH += "C:/Program Files (x86)/Graphviz2.38/include"
 
 
 
-SOURCES			= 	src/gfx/GProcess.cpp		\
+SOURCES			= 	src/gfx/ActionRouter.cpp	\
+                                src/gfx/GProcess.cpp		\
                                 src/gfx/GAction.cpp		\
+                                src/gfx/GActionLayer.cpp	\
+                                src/gfx/GLabelItem.cpp	\
                                 src/gfx/GSort.cpp		\
+                                src/gfx/LevelOfDetail.cpp	\
                                 src/gfx/PHScene.cpp		\
+                                src/gfx/SortIndex.cpp		\
+                                src/gviz/ForceLayout.cpp	\
+                                src/gviz/GVLayoutCache.cpp	\
+                                src/gviz/GVLayoutService.cpp	\
                                 src/gviz/GVSkeletonGraph.cpp	\
+                                src/gviz/LayoutStrategy.cpp	\
                                 src/io/IO.cpp			\
                                 src/io/PHIO.cpp			\
+                                src/io/PNGWriter.cpp		\
                                 src/ph/Action.cpp		\
                                 src/ph/PH.cpp			\
                                 src/ph/Process.cpp		\
@@ -74,15 +95,23 @@ QMAKE_CXXFLAGS += -std=c++0x
 QMAKE_CXXFLAGS += -std=c++11
 QMAKE_CXXFLAGS += -ggdb
 
-QT += widgets
+QT += widgets concurrent
 
 test {
 
         QMAKE_CXXFLAGS += -ggdb
         QT += testlib
-        HEADERS +=	headers/test/PHIOTest.h
+        HEADERS +=	headers/test/PHIOTest.h	\
+                        headers/test/SortIndexTest.h
         SOURCES	+= 	src/test/TestRunner.cpp	\
-                        src/test/PHIOTest.cpp
+                        src/test/PHIOTest.cpp	\
+                        src/test/SortIndexTest.cpp
+
+} else:batch {
+
+        # headless tool: qmake CONFIG+=batch
+        TARGET   = gph-batch
+        SOURCES	+= src/Main2.cpp
 
 } else {
         SOURCES	+= src/Main.cpp
@@ -0,0 +1,64 @@
+#pragma once
+#include <QPainterPath>
+#include <QPointF>
+#include <QVector>
+#include "SortIndex.h"
+
+/**
+  * @file ActionRouter.h
+  * @brief header for the ActionRouter class
+  *
+  */
+
+class GSort;
+
+
+/**
+  * @class ActionRouter
+  * @brief routes the hits of the actions around the sorts they would cross
+  * @details the sorts in the way are found through the SortIndex of the scene, by walking the cells crossed by the
+  * hit: routing a hit costs the length of the hit, not the number of sorts. Each sort crossed is passed on the side
+  * opposite to its center, and the hit is drawn as a smooth curve through these detours.
+  *
+  */
+class ActionRouter {
+
+  public:
+
+    /**
+      * @brief space kept between a routed hit and the sorts it goes round, in pixels
+      *
+      */
+    static const qreal margin;
+
+    /**
+      * @brief largest number of sorts a hit goes round, the rest of the hit being straight
+      *
+      */
+    static const int maxDetours;
+
+    /**
+      * @brief computes the route of a hit
+      * @param SortIndex the index of the sorts of the scene
+      * @param QPointF the start of the hit
+      * @param QPointF the end of the hit
+      * @param GSort* the sort of the start, not seen as an obstacle
+      * @param GSort* the sort of the end, not seen as an obstacle
+      * @return QVector<QPointF> the points the hit goes through, from the start to the end
+      *
+      */
+    static QVector<QPointF> route(const SortIndex& index, const QPointF& from, const QPointF& to, const GSort* source, const GSort* target);
+
+    /**
+      * @brief adds a route to a path that is at the start of the route
+      * @details a route with no detour is a straight line, the others a Catmull-Rom spline through their points
+      * @param QPainterPath the path
+      * @param QVector<QPointF> the route
+      *
+      */
+    static void addRoute(QPainterPath& path, const QVector<QPointF>& route);
+
+  private:
+
+    ActionRouter();
+};
@@ -171,7 +171,11 @@ class Area : public QWidget {
 
   private:
 
-    QFile tempXML;
+    /**
+      * @brief temporary binary layout file, written before each edition and read back after update
+      *
+      */
+    QFile tempLayout;
 
   signals:
 
@@ -183,7 +187,7 @@ class Area : public QWidget {
     void edition();
 
     /**
-      * @brief Moment when the XML temporary file has to be write
+      * @brief Moment when the temporary layout file has to be write
       *
       */
 
@@ -246,13 +250,14 @@ class Area : public QWidget {
     void hideToolTip();
 
     /**
-      * @brief method to make the XML temporary file before edition
+      * @brief method to make the temporary layout file before edition
+      * @details the layout is saved in the binary format of PHIO::exportBinaryLayout
       *
       */
     void tempXMLfile();
 
     /**
-      * @brief method to delete the XML temporary file after update
+      * @brief method to delete the temporary layout file after update
       *
       */
     void deleteTempXML();
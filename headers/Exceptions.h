@@ -53,6 +53,14 @@ struct not_regular_file: virtual io_error { };
   */
 struct wrong_import_file: virtual io_error { };
 
+/**
+  * @class wrong_layout_format
+  * @brief struct defining the exception called when a binary layout file is truncated or has an unknown version
+    extends io_error
+  *
+  */
+struct wrong_layout_format: virtual io_error { };
+
 
 //Parse errors
 typedef error_info<struct parse_detail, string> parse_info;
@@ -0,0 +1,119 @@
+#pragma once
+#include <QPointF>
+#include <utility>
+#include <vector>
+
+/**
+  * @file ForceLayout.h
+  * @brief header for the ForceLayout class
+  *
+  */
+
+
+/**
+  * @brief struct containing a graph to lay out: square nodes of given sizes and the edges between them
+  *
+  */
+struct LayoutGraph {
+
+    /**
+      * @brief the width (and height) of each node, in pixels
+      *
+      */
+    std::vector<qreal> sizes;
+
+    /**
+      * @brief the edges, as pairs of indices of nodes
+      *
+      */
+    std::vector<std::pair<int, int> > edges;
+
+};
+
+
+/**
+  * @class ForceLayout
+  * @brief force-directed layout for the skeletons too large for dot
+  * @details spring-electrical model (Fruchterman-Reingold) whose repulsive forces are approximated with a Barnes-Hut
+  * quadtree, so that an iteration costs O(n log n) instead of O(n²); the forces of the nodes are computed on the threads
+  * of the global QThreadPool. The nodes that still overlap are then pushed apart, so that nodes are at least sep apart.
+  *
+  */
+class ForceLayout {
+
+  public:
+
+    /**
+      * @brief number of iterations of the force-directed placement
+      *
+      */
+    static const int iterations;
+
+    /**
+      * @brief Barnes-Hut opening criterion: a cell is seen as a single body from a distance larger than its width divided by theta
+      *
+      */
+    static const qreal theta;
+
+    /**
+      * @brief number of passes removing the overlaps between nodes before the layout is spread
+      *
+      */
+    static const int overlapPasses;
+
+    /**
+      * @brief factor by which the layout is spread when overlaps remain after overlapPasses passes
+      *
+      */
+    static const qreal spreadFactor;
+
+    /**
+      * @brief constructor
+      * @param LayoutGraph the graph to lay out
+      * @param qreal the minimum space between two nodes, in pixels
+      *
+      */
+    ForceLayout(const LayoutGraph& graph, qreal sep);
+
+    /**
+      * @brief lays out the graph
+      * @return vector the centers of the nodes, the top-left corner of the layout being (0,0)
+      *
+      */
+    std::vector<QPointF> run();
+
+  protected:
+
+    /**
+      * @brief computes the displacements of the nodes [begin, end) for an iteration
+      *
+      */
+    void computeForces(int begin, int end);
+
+    /**
+      * @brief moves apart the nodes that overlap
+      * @return bool true if some nodes were moved
+      *
+      */
+    bool removeOverlaps();
+
+    const LayoutGraph& graph;
+    qreal sep;
+
+    /**
+      * @brief ideal length of the edges
+      *
+      */
+    qreal k;
+
+    /**
+      * @brief adjacency lists of the nodes, in compressed form: the neighbours of i are adjacency[offsets[i]..offsets[i+1])
+      *
+      */
+    std::vector<int> offsets, adjacency;
+
+    std::vector<QPointF> positions, displacements;
+
+    class QuadTree;
+    QuadTree* tree;
+};
@@ -10,6 +10,8 @@
 
 #include <QGraphicsItem>
 #include <QColor>
+#include <QPainterPath>
+#include <QPen>
 #include <QSize>
 #include <QPoint>
 #include <vector>
@@ -27,12 +29,16 @@ typedef boost::shared_ptr<GAction> GActionPtr;
 class Action;
 typedef boost::shared_ptr<Action> ActionPtr;
 class PHScene;
+class GActionLayer;
 
 using std::pair;
 
 /**
   * @class GAction
   * @brief contains style and layout info to draw an action
+  * @details the paths and the pens of the action are kept in the GAction. Its graphical items, made from them by
+  * createItems, only exist in the scenes that do not draw their actions with a GActionLayer; in a culled scene,
+  * only the actions near the viewport have their paths (see layOut).
   *
   */
 class GAction {
@@ -67,19 +73,141 @@ class GAction {
       */
     void update();
 
+    /**
+      * @brief makes the graphical items of the action, for a scene that does not draw it with a GActionLayer
+      *
+      */
+    void createItems();
+
+    /**
+      * @brief makes the paths of the action, if it has none
+      * @details the actions of a culled scene have no paths until they come near the viewport, and are drawn as
+      * their straight hit meanwhile
+      *
+      */
+    void layOut();
+
+    /**
+      * @brief drops the paths of an action that has no items, once it is away from the viewport of a culled scene
+      *
+      */
+    void release();
+
+    /**
+      * @brief tells whether the action has its paths (see layOut)
+      *
+      */
+    bool isLaidOut();
+
+    /**
+      * @brief looks up the sorts and processes of the action in the scene, and keeps them for the updates
+      * @details done by the constructor; to be done again if the scene rebuilds the GSort or GProcess of the action
+      *
+      */
+    void resolve();
+
+    /**
+      * @brief indicates whether the GAction waits for an update (see PHScene::invalidateSort)
+      *
+      */
+    bool isDirty();
+
+    /**
+      * @brief marks the GAction as waiting, or no longer waiting, for an update
+      *
+      */
+    void setDirty(bool isDirty);
+
+    /**
+      * @brief shows or hides the GAction
+      *
+      */
+    void setVisible(bool isVisible);
+
+    /**
+      * @brief tells whether the GAction is shown
+      *
+      */
+    bool isVisible();
+
+    /**
+      * @brief sets the layer drawing the GAction instead of its own items
+      *
+      * @param GActionLayer* the layer
+      * @param int the index of the GAction in the layer
+      */
+    void setLayer(GActionLayer* l, int index);
+
     /**
       * @brief gets the display
       *
-      * @return QGraphicsItem the graphical item representing the Action
+      * @return QGraphicsItem the graphical item representing the Action, null if it has no items (see createItems)
       */
     QGraphicsItem* getDisplayItem (void);
 
+    /**
+      * @brief gets the hit part of the Action, computed on each call if the action is not laid out
+      *
+      * @return QPainterPath the hit line and its arrowhead, in scene coordinates
+      */
+    QPainterPath getHitPath (void);
+
+    /**
+      * @brief gets the pen of the hit part of the Action
+      *
+      */
+    QPen getHitPen (void);
+
+    /**
+      * @brief gets the bounce part of the Action, computed on each call if the action is not laid out
+      *
+      * @return QPainterPath the bounce arc and its arrowhead, in scene coordinates
+      */
+    QPainterPath getBoundPath (void);
+
+    /**
+      * @brief gets the pen of the bounce part of the Action
+      *
+      */
+    QPen getBoundPen (void);
+
+    /**
+      * @brief gets the hit as a straight line, drawn instead of the hit when zoomed out
+      *
+      * @return QLineF the line from the center of the source sort to the center of the target sort
+      */
+    QLineF getStraightHit (void);
+
     /**
       * @brief gets the action
       *
       */
     ActionPtr getAction();
 
+    /**
+      * @brief gets the GSort of the source of the action
+      *
+      */
+    GSort* getSourceSort();
+
+    /**
+      * @brief gets the GSort of the target of the action
+      *
+      */
+    GSort* getTargetSort();
+
+    /**
+      * @brief gets the GSort of the result of the action
+      *
+      */
+    GSort* getResultSort();
+
+    /**
+      * @brief tells whether the sorts of the source, the target and the result of the action are all visible
+      *
+      */
+    bool hasVisibleSorts();
+
     /**
       * @brief gets the source GProcess item
       *
@@ -150,24 +278,60 @@ class GAction {
       */
     QGraphicsPathItem* boundArc;
 
+    /**
+      * @brief the line of the first part of the action, empty if the action is not laid out
+      *
+      */
+    QPainterPath hitPath;
+
+    /**
+      * @brief the arc of the second part of the action, empty if the action is not laid out
+      *
+      */
+    QPainterPath boundPath;
+
+    /**
+      * @brief the pen of the first part of the action
+      *
+      */
+    QPen hitPen;
+
+    /**
+      * @brief the pen of the second part of the action
+      *
+      */
+    QPen boundPen;
+
+    /**
+      * @brief if the action is shown
+      *
+      */
+    bool visible;
+
+    /**
+      * @brief if the action has its paths
+      *
+      */
+    bool laidOut;
+
     /**
       * @brief target Point of the line representing the first part of the action
       *
       */
-    QPointF* targetPoint;
+    QPointF targetPoint;
 
     /**
       * @brief source Point of the line representing the first part of the action
       *
       */
-    QPointF* sourcePoint;
+    QPointF sourcePoint;
 
 
     /**
       * @brief source Point of the arc representing the second part of the action
       *
       */
-    QPointF* resultPoint;
+    QPointF resultPoint;
 
 
     /**
@@ -176,12 +340,66 @@ class GAction {
       */
     ActionPtr action;
 
+    /**
+      * @brief the GSorts of the source, target and result of the action, owned by the scene
+      *
+      */
+    GSort *sourceSort, *targetSort, *resultSort;
+
+    /**
+      * @brief the GProcesses of the source, target and result of the action, owned by their GSort
+      *
+      */
+    GProcess *source, *target, *result;
+
     /**
       * @brief if the action is in bold or not
       *
       */
     bool bold;
 
+    /**
+      * @brief if the action waits for an update
+      *
+      */
+    bool dirty;
+
+    /**
+      * @brief the layer drawing the action, null if its items are in the scene
+      *
+      */
+    GActionLayer* layer;
+
+    /**
+      * @brief the index of the action in its layer
+      *
+      */
+    int layerIndex;
+
+    /**
+      * @brief tells the layer, if any, that the action has changed
+      *
+      */
+    void changed();
+
+    /**
+      * @brief sets the paths of the action, and the ones of its items if any
+      *
+      */
+    void setPaths(const QPainterPath& hit, const QPainterPath& bound);
+
+    /**
+      * @brief sets the pen of the first part of the action, and the one of its item if any
+      *
+      */
+    void setHitPen(const QPen& pen);
+
+    /**
+      * @brief sets the pen of the second part of the action, and the one of its item if any
+      *
+      */
+    void setBoundPen(const QPen& pen);
+
     /**
       * @brief the pair of graphical items representing the tails of the arrows of the Action
       *
@@ -204,6 +422,12 @@ class GAction {
       */
     pair<GVEdge, GVEdge> edges;
 
+    /**
+      * @brief buffer of the last arrowhead drawn, reused so that drawing an arrowhead allocates nothing
+      *
+      */
+    QPolygonF arrowHead;
+
     /**
       * @brief init the position of sourcePointLine, targetPointLine and resultPointLine
       */
@@ -238,7 +462,7 @@ class GAction {
       * @return QGraphicsPolygonItem* the graphical item representing the head of the arrow
       *
       */
-    QPolygonF makeArrowHead(QPainterPath path);
+    const QPolygonF& makeArrowHead(const QPainterPath& path);
 
     /**
       * @brief init contact points to display the GAction in simple model
@@ -298,5 +522,5 @@ class GAction {
       * @brief check if the hit needs to be curved
       *
       */
-    bool isCurvedHit(GSortPtr sourceSort,GSortPtr targetSort,  GProcessPtr source,  GProcessPtr target);
+    bool isCurvedHit();
 };
@@ -0,0 +1,83 @@
+#pragma once
+#include <QGraphicsItem>
+#include <QRectF>
+#include <QVector>
+
+/**
+  * @file GActionLayer.h
+  * @brief header for the GActionLayer class
+  *
+  */
+
+class GAction;
+
+
+/**
+  * @class GActionLayer
+  * @brief single graphical item drawing all the actions of a large scene
+  * @details above threshold actions, and in culled scenes, the actions have no items: the layer keeps the actions
+  * and their bounding rectangles in flat arrays and paints, in one call, the paths of the visible actions crossing the
+  * exposed area. The scene thus indexes one item instead of three per action. Like the items of the actions, the layer
+  * handles no click: the clicks go through it to the sorts and the scene.
+  *
+  */
+class GActionLayer : public QGraphicsItem {
+
+  public:
+
+    /**
+      * @brief number of actions from which the scene draws its actions with a GActionLayer
+      *
+      */
+    static const int threshold;
+
+    /**
+      * @brief constructor
+      *
+      */
+    GActionLayer();
+
+    /**
+      * @brief adds an action to the layer, which the action then tells of its changes
+      * @param GAction* the action, owned by the scene
+      *
+      */
+    void addAction(GAction* a);
+
+    /**
+      * @brief takes into account a change of the geometry, style or visibility of an action
+      * @param int the index of the action in the layer
+      *
+      */
+    void actionChanged(int index);
+
+    QRectF boundingRect() const;
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
+
+  protected:
+
+    /**
+      * @brief the actions drawn
+      *
+      */
+    QVector<GAction*> actions;
+
+    /**
+      * @brief the rectangle of each action, pens included
+      *
+      */
+    QVector<QRectF> bounds;
+
+    /**
+      * @brief union of the rectangles of the actions
+      *
+      */
+    QRectF area;
+
+    /**
+      * @brief computes the rectangle of an action
+      *
+      */
+    static QRectF boundsOf(GAction* a);
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <QColor>
+#include <QFont>
+#include <QFontMetricsF>
+#include <QGraphicsItem>
+#include <QHash>
+#include <QStaticText>
+#include <QString>
+
+/**
+  * @file GLabelItem.h
+  * @brief header for the GLabelItem class
+  *
+  */
+
+
+/**
+  * @class GLabelItem
+  * @brief single line of plain text labelling a sort or a process
+  * @details unlike QGraphicsTextItem, the label holds no QTextDocument: its size comes from font metrics shared by
+  * all the labels of a font, and its text is a QStaticText, laid out once at its first paint and then drawn as is.
+  * The label is not drawn under LevelOfDetail::text.
+  *
+  */
+class GLabelItem : public QGraphicsItem {
+
+  public:
+
+    /**
+      * @brief space, in pixels, around the text (as the default margin of a QTextDocument)
+      *
+      */
+    static const qreal margin;
+
+    /**
+      * @brief constructor
+      * @param QString the text of the label
+      * @param QFont the font of the label
+      * @param QGraphicsItem the parent item
+      *
+      */
+    GLabelItem(const QString& text, const QFont& font, QGraphicsItem* parent = 0);
+
+    /**
+      * @brief gets the text of the label
+      *
+      */
+    QString toPlainText() const;
+
+    /**
+      * @brief gets the font of the label
+      *
+      */
+    QFont font() const;
+
+    /**
+      * @brief sets the font of the label
+      *
+      */
+    void setFont(const QFont& f);
+
+    /**
+      * @brief gets the color of the text
+      *
+      */
+    QColor defaultTextColor() const;
+
+    /**
+      * @brief sets the color of the text
+      *
+      */
+    void setDefaultTextColor(const QColor& c);
+
+    /**
+      * @brief gets the size of the label, margins included
+      *
+      */
+    QSizeF size() const;
+
+    /**
+      * @brief gets the size a label would have, margins included, without making the label
+      * @param QString the text of the label
+      * @param QFont the font of the label
+      *
+      */
+    static QSizeF sizeOf(const QString& text, const QFont& font);
+
+    QRectF boundingRect() const;
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
+
+  protected:
+
+    /**
+      * @brief the text, laid out at its first paint
+      *
+      */
+    QStaticText staticText;
+
+    /**
+      * @brief the font of the text
+      *
+      */
+    QFont textFont;
+
+    /**
+      * @brief the color of the text
+      *
+      */
+    QColor color;
+
+    /**
+      * @brief the size of the text, margins excluded
+      *
+      */
+    QSizeF textSize;
+
+    /**
+      * @brief computes the size of the text with the metrics of its font
+      *
+      */
+    void measure();
+
+    /**
+      * @brief gets the metrics of a font, computed once for all the labels using it
+      *
+      */
+    static const QFontMetricsF& metrics(const QFont& f);
+};
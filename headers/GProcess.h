@@ -1,7 +1,9 @@
 #pragma once
 #include <QGraphicsItem>
 #include <QGraphicsEllipseItem>
-#include <QGraphicsTextItem>
+#include <QBrush>
+#include <QPen>
+#include "GLabelItem.h"
 #include <list>
 #include "PH.h"
 #include "Process.h"
@@ -21,6 +23,8 @@ typedef boost::shared_ptr<Process> ProcessPtr;
 /**
   * @class GProcess
   * @brief contains style and layout info to draw a process
+  * @details the geometry and the style of the process are kept in the GProcess, its graphical items being made
+  * from them by createItems: the processes of the sorts out of the viewport of a culled scene have none.
   *
   */
 class GProcess {
@@ -51,25 +55,74 @@ class GProcess {
       */
     ProcessPtr getProcessPtr();
 
+    /**
+      * @brief makes the graphical items of the process, from its geometry and its style
+      *
+      * @param QGraphicsItem the item of the sort of the process, parent of the items
+      */
+    void createItems(QGraphicsItem* parent);
+
+    /**
+      * @brief deletes the graphical items of the process, its geometry and its style being kept
+      *
+      */
+    void deleteItems();
+
+    /**
+      * @brief tells whether the process has its graphical items (see createItems)
+      *
+      */
+    bool hasItems();
+
     /**
       * @brief gets the display
       *
-      * @return QGraphicsItem the graphical item representing the Process
+      * @return QGraphicsItem the graphical item representing the Process, null if the process has no items
       */
     QGraphicsItem* getDisplayItem (void);
 
     /**
-      * @brief gets the ellipse
+      * @brief gets the ellipse, null if the process has no items
       *
       */
     QGraphicsEllipseItem* getEllipseItem();
 
     /**
-      * @brief gets the rect item that represents the margin of this GProcess
+      * @brief gets the rect item that represents the margin of this GProcess, null if the process has no items
       *
       */
     QGraphicsRectItem* getMarginRect();
 
+    /**
+      * @brief gets the pen of the ellipse
+      *
+      */
+    QPen getEllipsePen();
+
+    /**
+      * @brief sets the pen of the ellipse
+      *
+      */
+    void setEllipsePen(const QPen& pen);
+
+    /**
+      * @brief gets the brush of the ellipse
+      *
+      */
+    QBrush getEllipseBrush();
+
+    /**
+      * @brief sets the brush of the ellipse
+      *
+      */
+    void setEllipseBrush(const QBrush& brush);
+
+    /**
+      * @brief gets the rectangle of the ellipse in the scene
+      *
+      */
+    QRectF getSceneRect();
+
     /**
       * @brief get the center of the ellipse representing the process
       *
@@ -87,10 +140,22 @@ class GProcess {
     QSizeF* getSizeEllipse();
 
     /**
-      * @brief gets the text item
+      * @brief gets the text item, null if the process has no items
       *
       */
-    QGraphicsTextItem* getText();
+    GLabelItem* getText();
+
+    /**
+      * @brief gets the font of the number of the process
+      *
+      */
+    QFont getLabelFont();
+
+    /**
+      * @brief gets the color of the number of the process
+      *
+      */
+    QColor getLabelColor();
 
     /**
       * @brief updates the related center's coordinates with a point
@@ -167,6 +232,18 @@ class GProcess {
       */
     QSizeF* size;
 
+    /**
+      * @brief the pen of the ellipse
+      *
+      */
+    QPen pen;
+
+    /**
+      * @brief the brush of the ellipse
+      *
+      */
+    QBrush brush;
+
     /**
       * @brief the graphical item representing the Process
       *
@@ -183,7 +260,7 @@ class GProcess {
       * @brief the graphical item representing the text of the Process
       *
       */
-    QGraphicsTextItem* text;
+    GLabelItem* text;
 
     /**
       * @brief the margin around this process, must exclude any other process' margin (cf. graphviz attribute "pos" in GVSubGraph)
@@ -226,17 +303,23 @@ class GProcess {
 
     /**
       * @brief init the ellipse item
+      *
+      * @param QPointF the center of the ellipse in the coordinates of the display
       */
-    void initEllipseItem();
+    void initEllipseItem(QPointF localCenter);
 
     /**
       * @brief init the marginRect item
+      *
+      * @param QPointF the center of the ellipse in the coordinates of the display
       */
-    void initMarginRectItem();
+    void initMarginRectItem(QPointF localCenter);
 
     /**
       * @brief init the text item
+      *
+      * @param QPointF the center of the ellipse in the coordinates of the display
       */
-    void initTextItem();
+    void initTextItem(QPointF localCenter);
 
 };
@@ -1,6 +1,6 @@
 #pragma once
 #include <QGraphicsRectItem>
-#include <QGraphicsTextItem>
+#include "GLabelItem.h"
 #include <QColor>
 #include <QSize>
 #include <QPoint>
@@ -9,6 +9,7 @@
 #include "Sort.h"
 #include "GVNode.h"
 #include "GProcess.h"
+#include "LevelOfDetail.h"
 #include "PHScene.h"
 
 /**
@@ -27,9 +28,12 @@ typedef boost::shared_ptr<GProcess> GProcessPtr;
 /**
   * @class GSort
   * @brief contains style and layout info to draw a Sort
+  * @details the GSort is the rectangle of the sort, and the parent of its label and of the items of its processes.
+  * These child items are made from the geometry and the style kept in the GSort and its GProcess: a culled scene
+  * only makes them for the sorts around its viewport (see PHScene::setViewport).
   *
  */
-class GSort : public QGraphicsRectItem {
+class GSort : public FlatRectItem {
 
   public:
 
@@ -50,11 +54,29 @@ class GSort : public QGraphicsRectItem {
     ~GSort();
 
     /**
-      * @brief get the rect item
+      * @brief get the rect item, that is the GSort itself, holding the pen and the brush of the sort
       *
       */
     QGraphicsRectItem* getRect();
 
+    /**
+      * @brief makes the label of the sort and the items of its processes
+      *
+      */
+    void createItems();
+
+    /**
+      * @brief deletes the label of the sort and the items of its processes, their geometry and style being kept
+      *
+      */
+    void deleteItems();
+
+    /**
+      * @brief tells whether the sort has its label and the items of its processes (see createItems)
+      *
+      */
+    bool hasItems();
+
     /**
       * @brief the color used by the Actions that have this Sort as source
       *
@@ -106,10 +128,28 @@ class GSort : public QGraphicsRectItem {
     GVNode getNode();
 
     /**
-      * @brief gets the text of the sort
+      * @brief gets the text of the sort, null if the sort has no items
       *
       */
-    QGraphicsTextItem* getText();
+    GLabelItem* getText();
+
+    /**
+      * @brief gets the font of the label of the sort
+      *
+      */
+    QFont getLabelFont();
+
+    /**
+      * @brief gets the color of the label of the sort
+      *
+      */
+    QColor getLabelColor();
+
+    /**
+      * @brief gets the rectangle of the label of the sort, above the sort, in scene coordinates
+      *
+      */
+    QRectF getLabelRect();
 
     /**
       * @brief gets the point used to record mouse press event position
@@ -133,6 +173,14 @@ class GSort : public QGraphicsRectItem {
       */
     QPointF getCenterPoint();
 
+    /**
+      * @brief get the rectangle of the GSort in the scene
+      *
+      * @return QRectF the rectangle, in scene coordinates
+      *
+      */
+    QRectF getSceneRect();
+
     /**
       * @brief get the size of the ellipse representing the process
       *
@@ -153,6 +201,22 @@ class GSort : public QGraphicsRectItem {
 
     void changeDisplayState();
 
+    /**
+      * @brief moves the GSort so that its left top corner lies on the given point
+      * @details actions are not updated, the caller has to call PHScene::updateActions once all the sorts are moved
+      *
+      * @param QPointF the new left top corner, in scene coordinates
+      */
+    void moveTo(QPointF leftTopCornerPoint);
+
+    /**
+      * @brief sets the orientation of the GSort
+      * @details actions are not updated, the caller has to call PHScene::updateActions once all the sorts are set
+      *
+      * @param bool true for a vertical GSort, false for an horizontal one
+      */
+    void setVertical(bool isVertical);
+
     /**
           * @brief setters for simpleDisplay attributes
           *
@@ -230,17 +294,11 @@ class GSort : public QGraphicsRectItem {
       */
     QSize* sizeRect;
 
-    /**
-      * @brief the graphical item representing the rectangle of the Sort
-      *
-      */
-    QGraphicsRectItem* _rect;
-
     /**
       * @brief the graphical item representing the text of the Sort
       *
       */
-    QGraphicsTextItem* text;
+    GLabelItem* text;
 
     /**
       * @brief the related Sort
@@ -336,7 +394,7 @@ class GSort : public QGraphicsRectItem {
     void initGeometricAttributes(QSize size);
 
     /**
-          * @brief initialize the _rect item of the GSort
+          * @brief initialize the pen and the brush of the GSort
           *
           */
     void initRectItem();
@@ -361,18 +419,18 @@ class GSort : public QGraphicsRectItem {
     void shiftPosition(QPointF shiftVector);
 
     /**
-      * @brief check if the GSort is over another
+      * @brief shifts the GSort and its GProcess children without updating the actions
       *
-    * @return bool the result of the checking
+    * @param QPointF the shifting vector
       */
-    bool isOverAnotherGSort();
+    void shiftGeometry(QPointF shiftVector);
 
     /**
-      * @brief check if the GSort is over a specified GSort
+      * @brief check if the GSort is over another, that is closer to it than defaultDistance (see SortIndex::isFree)
       *
     * @return bool the result of the checking
       */
-    bool isOver(GSort* otherGSort);
+    bool isOverAnotherGSort();
 
     /**
       * @brief set the position of the GSort at the state before it has moved
@@ -0,0 +1,65 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "GVNode.h"
+
+/**
+  * @file GVLayoutCache.h
+  * @brief header for the GVLayoutCache class
+  *
+  */
+
+
+/**
+  * @class GVLayoutCache
+  * @brief keeps the layouts computed by graphviz, so that a skeleton that has already been laid out is not laid out again
+  * @details layouts are identified by a hash of the skeleton graph (nodes, sizes, edges and layout parameters);
+  * they are kept in memory for the session and on disk, in the cache directory of the user, between sessions
+  *
+  */
+class GVLayoutCache {
+
+  public:
+
+    /**
+      * @brief maximum number of nodes of the layouts kept in memory
+      *
+      */
+    static const int memoryNodes;
+
+    /**
+      * @brief version of the files of the cache, to be changed whenever the layout of a given skeleton changes
+      *
+      */
+    static const quint32 version;
+
+    /**
+      * @brief looks for the layout of a skeleton, in memory and then on disk
+      * @param QByteArray the hash of the skeleton
+      * @param QList<GVNode> filled with the nodes of the layout if it is found
+      * @return bool true if the layout was found
+      *
+      */
+    static bool find(const QByteArray& key, QList<GVNode>& nodes);
+
+    /**
+      * @brief keeps the layout of a skeleton, in memory and on disk
+      * @details failing to write the file of the cache is not an error: the layout is only kept in memory
+      * @param QByteArray the hash of the skeleton
+      * @param QList<GVNode> the nodes of the layout
+      *
+      */
+    static void insert(const QByteArray& key, const QList<GVNode>& nodes);
+
+  private:
+    GVLayoutCache() {}
+
+    /**
+      * @brief gives the path of the file holding a layout
+      * @param QByteArray the hash of the skeleton
+      * @return QString the path of the file, empty if there is no cache directory
+      *
+      */
+    static QString path(const QByteArray& key);
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <graphviz/gvc.h>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <locale.h>
+#include <string>
+
+/**
+  * @file GVLayoutService.h
+  * @brief header for the GVLayoutService class
+  *
+  */
+
+
+/**
+  * @class GVLayoutService
+  * @brief the graphviz context shared by all the skeleton graphs of the process
+  * @details the context and its plugins are loaded the first time a graph is built, and kept until the
+  * end of the process, instead of being set up and torn down for every layout
+  *
+  */
+class GVLayoutService {
+
+  public:
+
+    /**
+      * @class Lock
+      * @brief held during every call into graphviz
+      * @details graphviz reads and writes numbers with the C library, according to the locale of the calling
+      * thread, and keeps global state: a Lock serializes the calls of all threads and switches the numeric
+      * locale of the current thread alone to "C", instead of changing the locale of the whole process
+      *
+      */
+    class Lock {
+
+      public:
+        Lock();
+        ~Lock();
+
+      private:
+        Lock(const Lock&);
+        Lock& operator=(const Lock&);
+
+        QMutexLocker locker;
+#ifdef _WIN32
+        int perThread;
+        std::string previous;
+#else
+        locale_t previous;
+#endif
+    };
+
+    /**
+      * @brief gets the service of the process, creating the graphviz context on the first call
+      *
+      * @return GVLayoutService& the service
+      */
+    static GVLayoutService& instance();
+
+    /**
+      * @brief gets the graphviz context, to be used while holding a Lock
+      *
+      * @return GVC_t* the context
+      */
+    GVC_t* context();
+
+    /**
+      * @brief lays out a graph, replacing its previous layout if any
+      * @param Agraph_t* the graph
+      * @param QString the name of the graphviz layout engine
+      * @return bool false if the engine is not available or failed
+      */
+    bool layout(Agraph_t* graph, const QString& alg);
+
+    /**
+      * @brief frees the layout of a graph, before it is closed
+      * @param Agraph_t* the graph
+      */
+    void freeLayout(Agraph_t* graph);
+
+    /**
+      * @brief renders a laid out graph into a file
+      * @param Agraph_t* the graph
+      * @param QString the graphviz output format
+      * @param QString the path of the file
+      */
+    void render(Agraph_t* graph, const QString& format, const QString& path);
+
+  private:
+    GVLayoutService();
+    ~GVLayoutService();
+    GVLayoutService(const GVLayoutService&);
+    GVLayoutService& operator=(const GVLayoutService&);
+
+    static QMutex& mutex();
+
+    GVC_t* _context;
+};
@@ -22,6 +22,13 @@ struct GVNode {
       */
     QString name;
 
+    /**
+      * @brief the index of the object the node stands for, -1 if unknown
+      * @details for the skeleton graph, the index of the sort in PH::skeletonSorts
+      *
+      */
+    int index = -1;
+
     /**
       * @brief position of the center point of the node from the top-left corner
       *
@@ -2,6 +2,7 @@
 #include <graphviz/gvc.h>
 #include <boost/shared_ptr.hpp>
 #include <QFont>
+#include <QHash>
 #include <QMap>
 #include <QPair>
 #include <QString>
@@ -22,6 +23,9 @@ typedef boost::shared_ptr<GVSkeletonGraph> GVSkeletonGraphPtr;
 /**
   * @class GVSkeletonGraph
   * @brief the object containing a libraph graph representing the skeleton (sorts+actions) of the model and its associated nodes and edges
+  * @details graphs may be built and laid out from any thread: the calls into graphviz are serialized and
+  * made with the "C" numeric locale of the calling thread, the locale of the process is never changed;
+  * all the graphs share the graphviz context of the GVLayoutService
   *
   */
 class GVSkeletonGraph {
@@ -57,6 +61,12 @@ class GVSkeletonGraph {
      */
     static const qreal sepValue;
 
+    /**
+     * @brief DPI of the layout, so that the coordinates of the nodes are given in pixels of the scene
+     *
+     */
+    static const qreal layoutDPI;
+
     // Graph management
 
     /**
@@ -84,8 +94,10 @@ class GVSkeletonGraph {
 
     /**
      * @brief builds the layout
+     * @param QString alg the graphviz layout engine: dot, neato, sfdp, fdp or circo (see LayoutStrategy)
+     * @return bool false if the engine is not available or failed
      */
-    void  applyLayout();
+    bool  applyLayout(const QString& alg = "dot");
 
     /**
      * @brief export the graph into the file out.png (for test purpose)
@@ -104,8 +116,9 @@ class GVSkeletonGraph {
     /**
      * @brief add a node to the graph
      * @param QString name the name of the node to add to the graph
+     * @param int index the index given back in the GVNode of the node by nodes()
      */
-    void addNode(const QString& name);
+    void addNode(const QString& name, int index = -1);
 
     /**
      * @brief remove a node from the graph
@@ -148,6 +161,15 @@ class GVSkeletonGraph {
      */
     void addEdge(const QString &source, const QString &target);
 
+    /**
+     * @brief add a edge to the graph between two nodes already retrieved
+     * @details no lookup by name is done, and the edge is not recorded for connectionExists and removeEdge:
+     * the caller must not add the same edge twice
+     * @param Agnode_t* source the first node related to the edge
+     * @param Agnode_t* target the second node related to the edge
+     */
+    void addEdge(Agnode_t* source, Agnode_t* target);
+
     /**
      * @brief remove a edge to the graph
      * @param QString source the name first node related to the edge
@@ -186,8 +208,8 @@ class GVSkeletonGraph {
   protected:
 
     QFont _font;
-    GVC_t *_context;
     Agraph_t* _graph;
     QMap<QString, Agnode_t*> _nodes;
+    QHash<Agnode_t*, int> _indices;
     QMap<QPair<QString, QString>, Agedge_t*> _edges;
 };
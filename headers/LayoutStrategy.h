@@ -0,0 +1,138 @@
+#pragma once
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+/**
+  * @file LayoutStrategy.h
+  * @brief header for the LayoutStrategy class
+  *
+  */
+
+
+/**
+  * @class LayoutStrategy
+  * @brief chooses the algorithm laying out a skeleton graph, and keeps the time taken by each algorithm
+  * @details by default (Auto) the algorithm is chosen from the number of nodes and edges: dot for small graphs,
+  * sfdp for medium ones and the built-in ForceLayout for the largest; an algorithm whose recorded speed predicts
+  * that a graph would take more than timeBudget is passed over for the next, faster one
+  *
+  */
+class LayoutStrategy {
+
+  public:
+
+    /**
+      * @brief the layout algorithms: the graphviz engines and the built-in ForceLayout
+      *
+      */
+    enum Algorithm { Auto, Dot, Neato, Sfdp, Fdp, Circo, Force };
+
+    /**
+      * @brief the time taken by the layouts of an algorithm
+      *
+      */
+    struct Stats {
+        int runs;
+        qint64 totalMs;
+        qint64 maxMs;
+
+        /**
+          * @brief the largest time per node and edge observed, in milliseconds
+          *
+          */
+        double msPerElement;
+    };
+
+    /**
+      * @brief largest graph, in nodes, laid out by dot when the algorithm is chosen automatically
+      *
+      */
+    static const int dotMaxNodes;
+
+    /**
+      * @brief largest graph, in edges, laid out by dot when the algorithm is chosen automatically
+      *
+      */
+    static const int dotMaxEdges;
+
+    /**
+      * @brief largest graph, in nodes, laid out by sfdp when the algorithm is chosen automatically
+      *
+      */
+    static const int sfdpMaxNodes;
+
+    /**
+      * @brief time, in milliseconds, an automatically chosen algorithm is expected to stay under
+      *
+      */
+    static const qint64 timeBudget;
+
+    /**
+      * @brief gets the algorithm used for the layouts of the skeletons
+      *
+      * @return Algorithm the algorithm, Auto by default
+      */
+    static Algorithm getDefault();
+
+    /**
+      * @brief sets the algorithm used for the layouts of the skeletons
+      * @param Algorithm the algorithm, Auto to choose it for each graph
+      */
+    static void setDefault(Algorithm algorithm);
+
+    /**
+      * @brief chooses the algorithm laying out a graph
+      * @param int the number of nodes
+      * @param int the number of edges
+      * @return Algorithm the default algorithm if it is not Auto, otherwise the one suited to the size of the graph
+      */
+    static Algorithm choose(int nodes, int edges);
+
+    /**
+      * @brief keeps the time taken by a layout
+      * @param Algorithm the algorithm used
+      * @param int the number of nodes
+      * @param int the number of edges
+      * @param qint64 the time taken, in milliseconds
+      */
+    static void record(Algorithm algorithm, int nodes, int edges, qint64 ms);
+
+    /**
+      * @brief gives the time taken by the layouts of each algorithm since the beginning of the session
+      *
+      * @return QMap<Algorithm, Stats> the statistics of the algorithms used at least once
+      */
+    static QMap<Algorithm, Stats> statistics();
+
+    /**
+      * @brief gives the name of an algorithm, which is the name of the graphviz engine for the graphviz ones
+      * @param Algorithm the algorithm
+      * @return QString the name
+      */
+    static QString name(Algorithm algorithm);
+
+    /**
+      * @brief gives the algorithm of a given name
+      * @param QString the name, as given by name()
+      * @param bool* set to false if the name is unknown
+      * @return Algorithm the algorithm, Auto if the name is unknown
+      */
+    static Algorithm fromName(const QString& name, bool* ok = 0);
+
+    /**
+      * @brief gives the names of all the algorithms
+      *
+      * @return QStringList the names
+      */
+    static QStringList names();
+
+  private:
+    LayoutStrategy() {}
+
+    /**
+      * @brief tells if the time recorded for an algorithm predicts that a graph would take more than timeBudget
+      *
+      */
+    static bool tooSlow(Algorithm algorithm, int nodes, int edges);
+};
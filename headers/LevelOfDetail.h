@@ -0,0 +1,102 @@
+#pragma once
+#include <QGraphicsRectItem>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <utility>
+
+/**
+  * @file LevelOfDetail.h
+  * @brief header for the LevelOfDetail class and the graphical items drawn according to it
+  *
+  */
+
+
+/**
+  * @class LevelOfDetail
+  * @brief scales under which the details of the scene are not drawn
+  * @details the level of detail is the scale at which an item is drawn (QStyleOptionGraphicsItem::levelOfDetailFromTransform):
+  * 1 at 100%, 0.1 when zoomed out ten times. Under these levels, texts, processes, arrowheads and arcs would be a few
+  * pixels wide: they are skipped, the sorts are drawn as flat rectangles and the hits as straight lines.
+  *
+  */
+class LevelOfDetail {
+
+  public:
+
+    /**
+      * @brief level under which the texts are not drawn
+      *
+      */
+    static const qreal text;
+
+    /**
+      * @brief level under which the processes are not drawn, the sorts being flat rectangles
+      *
+      */
+    static const qreal process;
+
+    /**
+      * @brief level under which the arrowheads and bounce arcs are not drawn, the hits being straight lines
+      *
+      */
+    static const qreal action;
+
+    /**
+      * @brief gives the level of detail at which an item is painted
+      * @param QStyleOptionGraphicsItem the option given to paint
+      * @param QPainter the painter given to paint
+      * @return qreal the level of detail
+      *
+      */
+    static qreal of(const QStyleOptionGraphicsItem* option, const QPainter* painter);
+
+  private:
+
+    LevelOfDetail();
+};
+
+
+/**
+  * @class LodItem
+  * @brief graphical item of type Item that is not drawn under a given level of detail
+  *
+  */
+template <class Item>
+class LodItem : public Item {
+
+  public:
+
+    /**
+      * @brief constructor
+      * @param qreal the level of detail under which the item is not drawn
+      * @param args the arguments of the constructor of Item
+      *
+      */
+    template <typename... Args>
+    LodItem(qreal minimum, Args&&... args) : Item(std::forward<Args>(args)...), minimum(minimum) {}
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+        if (LevelOfDetail::of(option, painter) < minimum)
+            return;
+        Item::paint(painter, option, widget);
+    }
+
+  protected:
+
+    qreal minimum;
+};
+
+
+/**
+  * @class FlatRectItem
+  * @brief rectangle drawn as a flat area of its brush under LevelOfDetail::process
+  *
+  */
+class FlatRectItem : public QGraphicsRectItem {
+
+  public:
+
+    FlatRectItem(const QRectF& rect, QGraphicsItem* parent = 0) : QGraphicsRectItem(rect, parent) {}
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
+};
@@ -104,6 +104,8 @@ class MainWindow : public QMainWindow {
     QAction *actionSaveas;
     QMenu   *menuExport;
     QAction *actionPng;
+    QAction *actionSvg;
+    QAction *actionPdf;
     QAction *actionDot;
     QAction *actionExportTikzData;
     QAction *actionExportXMLData;
@@ -192,6 +194,18 @@ class MainWindow : public QMainWindow {
       */
     void exportPng();
 
+    /**
+      * @brief exports the current view to SVG file
+      *
+      */
+    void exportSvg();
+
+    /**
+      * @brief exports the current view to PDF file
+      *
+      */
+    void exportPdf();
+
     /**
       * @brief exports the current file to DOT file
       *
@@ -97,6 +97,12 @@ class MyArea : public QGraphicsView {
       */
     void setScalingFactor(float);
 
+    /**
+      * @brief tells the scene which area is visible, so that a culled scene puts the sorts around it in the scene
+      *
+      */
+    void updateViewport();
+
 
 
   protected:
@@ -118,6 +124,18 @@ class MyArea : public QGraphicsView {
       */
     float scalingFactor;
 
+    /**
+      * @brief updates the viewport of the scene when scrolling
+      *
+      */
+    void scrollContentsBy(int dx, int dy);
+
+    /**
+      * @brief updates the viewport of the scene when resized
+      *
+      */
+    void resizeEvent(QResizeEvent *event);
+
   signals:
 
   public slots:
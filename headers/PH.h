@@ -2,10 +2,13 @@
 #include <list>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 #include "Action.h"
 #include "GVSkeletonGraph.h"
+#include "LayoutStrategy.h"
 #include "PHScene.h"
 #include "Sort.h"
 
@@ -19,6 +22,8 @@
 using std::list;
 using std::map;
 using std::string;
+using std::pair;
+using std::vector;
 using boost::make_shared;
 
 // mutual inclusion
@@ -40,6 +45,44 @@ static inline QString makeSkeletonNodeName (string s) {
     return QString::fromStdString("sort_"+s);
 }
 
+/**
+  * @brief struct containing a connected component of the skeleton graph, laid out on its own
+  *
+  */
+struct SkeletonComponent {
+
+    /**
+      * @brief the sorts of the component
+      *
+      */
+    vector<SortPtr> sorts;
+
+    /**
+      * @brief the indices of the sorts of the component in the whole skeleton graph, given to the nodes of its layout
+      *
+      */
+    vector<int> indices;
+
+    /**
+      * @brief the edges between the sorts of the component, as pairs of indices in sorts
+      *
+      */
+    vector<pair<int, int> > edges;
+
+    /**
+      * @brief the nodes of the component once laid out, in the coordinates of the component
+      *
+      */
+    QList<GVNode> nodes;
+
+    /**
+      * @brief the algorithm laying out the component, Auto to choose it when the component is laid out
+      *
+      */
+    LayoutStrategy::Algorithm algorithm = LayoutStrategy::Auto;
+
+};
+
 /**
   * @class PH
   * @brief represents an entire process hitting as defined in a PH file
@@ -85,6 +128,12 @@ class PH {
       */
     list<SortPtr> getSorts(void);
 
+    /**
+      * @brief gives the sorts in the order of their indices in the skeleton graph, the index of the GVNode of a sort
+      *
+      */
+    vector<SortPtr> skeletonSorts(void);
+
     /**
       * @brief getter for the processes of the PH
       *
@@ -110,6 +159,15 @@ class PH {
       */
     void render (void);
 
+    /**
+      * @brief calls for the process hitting in its scene, after an edition of the model
+      * @details the sorts of the previous version keep their place and only the new sorts are placed, next to
+      * their neighbours, so that graphviz is not called and the cost depends on the number of new sorts
+      * @param PHPtr the previous version of the model, already rendered
+      *
+      */
+    void render (PHPtr previous);
+
     /**
       * @brief make the skeletonGraph related to the ph model
       * @details calls graphviz to calculate the optimized graph
@@ -119,6 +177,34 @@ class PH {
 
     GVSkeletonGraphPtr createSkeletonGraph(void);
 
+    /**
+      * @brief gives the layout of the skeleton graph of the ph model
+      * @details the layout is taken from the GVLayoutCache if the skeleton (sorts, sizes and edges) has already been
+      * laid out, which is the case when only rates or processes that do not change the size of a sort are edited;
+      * otherwise the skeleton is laid out by layoutComponents and its layout added to the cache
+      * @return QList<GVNode> the nodes of the skeleton, placed
+      *
+      */
+    QList<GVNode> layoutSkeleton(void);
+
+    /**
+      * @brief gives the hash identifying the skeleton graph in the GVLayoutCache
+      * @return QByteArray the SHA-1 of the sorts, their sizes, the edges and the layout parameters
+      *
+      */
+    QByteArray skeletonHash(void);
+
+    /**
+      * @brief gives the layout of the skeleton graph keeping the positions of the sorts drawn in a previous scene
+      * @details sorts that are not in the previous scene are placed at the free spot the nearest to the mean of
+      * their neighbours already placed, or on the right of the graph if they have none; if no sort of the previous
+      * scene is kept, the skeleton is laid out as a whole by layoutSkeleton
+      * @param PHScenePtr the scene of the previous version of the model
+      * @return QList<GVNode> the nodes of the skeleton, placed
+      *
+      */
+    QList<GVNode> layoutSkeletonFrom(PHScenePtr previous);
+
     /**
       * @brief outputs for display
       * @return PHScenePtr pointer to the Scene built
@@ -165,6 +251,68 @@ class PH {
 
   protected:
 
+    /**
+      * @brief gives the size of the node of a sort in the skeleton graph
+      * @param SortPtr the sort
+      * @return int the width and height of the node, in pixels
+      *
+      */
+    int skeletonNodeSize(SortPtr s);
+
+    /**
+      * @brief gives the whole skeleton graph, with its edges in the order they are added to it
+      * @details the edges are deduplicated on the indices of the sorts, in a single pass over the actions
+      * @return SkeletonComponent the sorts of the model, by name, and the pairs of indices of the sorts connected by at least one action
+      *
+      */
+    SkeletonComponent skeleton(void);
+
+    /**
+      * @brief build the skeleton graph of a part of the ph model and lay it out with graphviz
+      * @param SkeletonComponent the sorts and edges of the graph
+      * @param QString the graphviz layout engine
+      * @return GVSkeletonGraphPtr pointer to the Graph built, null if the engine is not available or failed
+      *
+      */
+    GVSkeletonGraphPtr createSkeletonGraph(const SkeletonComponent& component, const QString& alg);
+
+    /**
+      * @brief lays out a part of the skeleton graph with ForceLayout
+      * @param SkeletonComponent the sorts and edges of the graph
+      * @return QList<GVNode> the nodes, placed
+      *
+      */
+    QList<GVNode> forceLayoutSkeleton(const SkeletonComponent& component);
+
+    /**
+      * @brief splits the skeleton graph into its connected components
+      * @return vector the components, isolated sorts being components of their own
+      *
+      */
+    vector<SkeletonComponent> skeletonComponents(void);
+
+    /**
+      * @brief lays out a connected component of the skeleton graph
+      * @details an isolated sort is simply placed at the origin; other components are laid out by the algorithm
+      * of the component, or the one given by LayoutStrategy::choose if it is Auto, ForceLayout taking over if the
+      * graphviz engine is not available, and the time taken is recorded in the LayoutStrategy statistics
+      * @param SkeletonComponent the component
+      * @return QList<GVNode> the nodes of the component, placed in its own coordinates
+      *
+      */
+    QList<GVNode> layoutComponent(const SkeletonComponent& component);
+
+    /**
+      * @brief lays out the skeleton graph component by component
+      * @details the components laid out by ForceLayout run in parallel on the global QThreadPool; graphviz
+      * keeps global state and runs under GVLayoutService::Lock, so the components laid out by its engines are
+      * laid out one after the other on the calling thread, meanwhile. The components are then packed in rows
+      * of decreasing height
+      * @return QList<GVNode> the nodes of the skeleton, placed
+      *
+      */
+    QList<GVNode> layoutComponents(void);
+
     //Headers
 
     /**
@@ -3,6 +3,8 @@
 #include "PH.h"
 #include "MainWindow.h"
 #include <QXmlStreamWriter>
+#include <QPointF>
+#include <vector>
 
 /**
   * @file PHIO.h
@@ -13,6 +15,8 @@
 
 using std::string;
 
+class Area;
+
 /**
   * @class PHIO
   * @brief manages the inputs and outputs of the PH files
@@ -45,13 +49,46 @@ class PHIO {
       */
     static void writeToFile (string const& path, PHPtr ph);
 
+    /**
+      * @brief resolution of the scene as it is displayed in the GUI, in dots per inch
+      *
+      */
+    static const qreal screenDPI;
+
+    /**
+      * @brief maximum size in bytes of a band of the PNG image rendered at once
+      *
+      */
+    static const int pngBandBytes;
+
     /**
       * @brief saves as a PNG the representation of the PH file as it is displayed in the GUI
+      * @details the image is rendered by horizontal bands which are encoded while the next one is rendered,
+      * so that memory is bounded by the size of a band whatever the size of the scene
+      * @param PHPtr pointer to the PH object of the active window
+      * @param QString the name of the file saved
+      * @param qreal resolution of the image, in dots per inch (screenDPI gives the size displayed in the GUI)
+      *
+      */
+    static void exportToPNG (PHPtr ph, QString name, qreal dpi = screenDPI);
+
+    /**
+      * @brief saves as a SVG file the representation of the PH file as it is displayed in the GUI
+      * @details sorts, processes and actions are written as SVG elements one after the other,
+      * instead of being rendered, so that the file keeps the vectors and text of the graph
+      * @param PHPtr pointer to the PH object of the active window
+      * @param QString the name of the file saved
+      *
+      */
+    static void exportToSVG (PHPtr ph, QString name);
+
+    /**
+      * @brief saves as a single-page PDF file the representation of the PH file as it is displayed in the GUI
       * @param PHPtr pointer to the PH object of the active window
       * @param QString the name of the file saved
       *
       */
-    static void exportToPNG (PHPtr ph, QString name);
+    static void exportToPDF (PHPtr ph, QString name);
 
     /**
       * @brief saves as an XML file the layout and style information of the graph displayed in GUI
@@ -63,6 +100,25 @@ class PHIO {
 
     static void exportTikzMetadata(PHPtr ph, QFile &output);
 
+    /**
+      * @brief saves the layout of a tab as a compact binary file, the sidecar of the XML metadata
+      * @details the file holds a sort name table followed by fixed-size records (position, orientation,
+      * color, visibility) and the sort groups, so that it is written and read back in a single pass
+      *
+      * @param Area the tab whose layout is saved
+      * @param QFile the file to be written
+      */
+    static void exportBinaryLayout(Area *area, QFile &output);
+
+    /**
+      * @brief restores the layout of a tab from a file written by exportBinaryLayout
+      * @details sorts that are not in the current model are skipped
+      *
+      * @param Area the tab whose layout is restored
+      * @param QFile the file to be read
+      */
+    static void importBinaryLayout(Area *area, QFile &input);
+
   private:
     PHIO() {}
 
@@ -75,7 +131,10 @@ class PHIO {
     static PHPtr parse (string const& input);
 
     /**
-     *Function
-     */
-    static pair<int,int> findOrigin( list <pair <int, int> > txy);
+      * @brief chooses the sort whose center is the origin of the TikZ coordinates
+      * @param vector the centers of the visible sorts
+      * @return QPointF the center, truncated to whole pixels, of the sort the farthest from the mean along the axis of least variance
+      *
+      */
+    static QPointF findOrigin(const std::vector<QPointF>& centers);
 };
@@ -2,9 +2,15 @@
 #include <boost/shared_ptr.hpp>
 #include <QObject>
 #include <QGraphicsScene>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
 #include <map>
 #include <string>
 #include "GAction.h"
+#include "GVNode.h"
+#include "SortIndex.h"
 
 
 
@@ -26,6 +32,7 @@ class GSort;
 typedef boost::shared_ptr<GSort> GSortPtr;
 class GAction;
 typedef boost::shared_ptr<GAction> GActionPtr;
+class GActionLayer;
 
 class PHScene;
 typedef boost::shared_ptr<PHScene> PHScenePtr;
@@ -42,6 +49,54 @@ typedef std::pair<string, GSortPtr> GSortEntry;
 class PHScene: public QGraphicsScene {
 
   public:
+
+    /**
+      * @class BatchUpdate
+      * @brief scope in which the changes of the sorts do not update the actions: the actions marked meanwhile
+      * are updated once, when the outermost scope ends
+      *
+      */
+    class BatchUpdate {
+
+      public:
+
+        /**
+          * @brief begins a batch on a scene
+          * @param PHScene* the scene
+          *
+          */
+        BatchUpdate(PHScene* sc);
+
+        /**
+          * @brief ends the batch, updating the actions marked during it
+          *
+          */
+        ~BatchUpdate();
+
+      private:
+
+        PHScene* scene;
+    };
+
+    /**
+      * @brief delay, in milliseconds, gathering the updates of the actions asked for by invalidateSort (about one frame)
+      *
+      */
+    static const int updateInterval;
+
+    /**
+      * @brief number of sorts from which the scene is culled: only the sorts around the viewport are in the scene,
+      * with their items, and only the actions around it have their paths
+      *
+      */
+    static const int cullingThreshold;
+
+    /**
+      * @brief margin, in pixels, around the viewport in which the sorts of a culled scene are kept in the scene
+      *
+      */
+    static const qreal viewportMargin;
+
     /**
       * @brief constructor
       * @param PH* the PH graph to use
@@ -50,11 +105,18 @@ class PHScene: public QGraphicsScene {
     PHScene(PH* _ph);
 
     /**
-      * @brief create a GVSkeletonGraph from the PH object, then draw the PHSCene from it
+      * @brief lay out the skeleton graph of the PH object (see PH::layoutSkeleton), then draw the PHSCene from it
       *
       */
     void drawFromSkeleton(void);
 
+    /**
+      * @brief draw the PHScene from the placed nodes of the skeleton graph of the PH object
+      * @param QList<GVNode> the nodes, one for each sort
+      *
+      */
+    void drawFromLayout(const QList<GVNode>& gSkeletonNodes);
+
     /**
       * @brief gets a GSort by its related Sort's name
       * @param string the name of the (G)Sort to get
@@ -81,6 +143,40 @@ class PHScene: public QGraphicsScene {
       */
     std::vector<GActionPtr> getActions();
 
+    /**
+      * @brief gets the spatial index of the sorts of the scene
+      *
+      */
+    SortIndex& getSortIndex();
+
+    /**
+      * @brief tells whether only the sorts around the viewport are in the scene (see setViewport)
+      *
+      */
+    bool isCulled() const;
+
+    /**
+      * @brief sets the area seen by the view: in a culled scene, the sorts around it get their items (see
+      * GSort::createItems) and are put in the scene, the others are taken out of it and lose their items; the actions
+      * around it are laid out, the others drop their paths (see GAction::layOut). The GSort, GProcess and GAction
+      * themselves, holding the geometry and the style of the model, are kept for all the sorts.
+      * @param QRectF the visible area, in scene coordinates
+      *
+      */
+    void setViewport(const QRectF& visible);
+
+    /**
+      * @brief gets the area last seen by the view
+      *
+      */
+    const QRectF& getViewport() const;
+
+    /**
+      * @brief gets the area covered by the whole model, including the sorts out of a culled scene
+      *
+      */
+    QRectF getModelRect();
+
 
     /**
       * @brief update the position of actions
@@ -88,6 +184,49 @@ class PHScene: public QGraphicsScene {
       */
     void updateActions();
 
+    /**
+      * @brief gets the actions whose source, target or result is in a given sort
+      * @param GSort* the sort
+      * @return QVector<GAction*> the actions, each one once
+      *
+      */
+    const QVector<GAction*>& getIncidentActions(const GSort* s);
+
+    /**
+      * @brief marks the actions of a sort as to be updated
+      * @details the updates are gathered and done at most once per updateInterval, so that dragging a sort only
+      * updates its own actions, once per frame
+      * @param GSort* the sort that moved or changed
+      *
+      */
+    void invalidateSort(const GSort* s);
+
+    /**
+      * @brief marks the actions drawn over an area as to be updated, so that they are routed again
+      * @param QRectF the area, in scene coordinates
+      *
+      */
+    void invalidateArea(const QRectF& area);
+
+    /**
+      * @brief updates the actions marked by invalidateSort and invalidateArea at once
+      *
+      */
+    void flushActions();
+
+    /**
+      * @brief begins a batch of changes: until endBatch, updateActions, invalidateSort and invalidateArea only mark
+      * the actions to update, the areas invalidated being gathered in one (see BatchUpdate)
+      *
+      */
+    void beginBatch();
+
+    /**
+      * @brief ends a batch of changes begun by beginBatch: the last one updates the marked actions in one pass
+      *
+      */
+    void endBatch();
+
 
     /**
       * @brief switch the display mode between detailled/simplified
@@ -143,6 +282,72 @@ class PHScene: public QGraphicsScene {
       */
     std::vector<GActionPtr> actions;
 
+    /**
+      * @brief spatial index of the rectangles of the Sorts, used to route the Actions
+      *
+      */
+    SortIndex sortIndex;
+
+    /**
+      * @brief the item drawing all the Actions of a large scene, null if each Action has its own items (see GActionLayer)
+      *
+      */
+    GActionLayer* actionLayer;
+
+    /**
+      * @brief true if only the sorts around the viewport are in the scene
+      *
+      */
+    bool culled;
+
+    /**
+      * @brief the area last seen by the view
+      *
+      */
+    QRectF viewport;
+
+    /**
+      * @brief the Sorts of a culled scene currently in the scene, with their items
+      *
+      */
+    QSet<GSort*> shownSorts;
+
+    /**
+      * @brief the Actions of each Sort, whatever the role of the Sort in them
+      *
+      */
+    QHash<const GSort*, QVector<GAction*> > incidentActions;
+
+    /**
+      * @brief the Actions waiting for an update
+      *
+      */
+    QVector<GAction*> dirtyActions;
+
+    /**
+      * @brief timer of the next update of the dirty Actions
+      *
+      */
+    QTimer updateTimer;
+
+    /**
+      * @brief number of batches of changes begun and not ended
+      *
+      */
+    int batchDepth;
+
+    /**
+      * @brief true if updateActions was called during the current batch
+      *
+      */
+    bool fullUpdatePending;
+
+    /**
+      * @brief union of the areas invalidated during the current batch
+      *
+      */
+    QRectF pendingArea;
+
     /**
       * @brief creates GAction items from graphviz graph (GVEdge structs)
       *
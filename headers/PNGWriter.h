@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdio>
+#include <png.h>
+#include <QImage>
+#include <QString>
+
+/**
+  * @file PNGWriter.h
+  * @brief header for the PNGWriter class
+  * @author PGROU_2013
+  *
+  */
+
+
+/**
+  * @class PNGWriter
+  * @brief writes a PNG file row by row, so that an image never has to be held in memory as a whole
+  *
+  */
+class PNGWriter {
+
+  public:
+
+    /**
+      * @brief constructor: opens the file and writes the PNG header
+      *
+      * @param QString the path of the file to write
+      * @param int width of the image in pixels
+      * @param int height of the image in pixels
+      * @param qreal resolution of the image, in dots per inch
+      */
+    PNGWriter(QString path, int width, int height, qreal dpi);
+
+    ~PNGWriter();
+
+    /**
+      * @brief appends a band of rows to the image
+      *
+      * @param QImage the band to write: same width as the image, any format (converted to RGBA8888)
+      */
+    void writeRows(const QImage &band);
+
+    /**
+      * @brief writes the end of the PNG stream and closes the file
+      * @details all the rows of the image must have been written before
+      */
+    void finish();
+
+  protected:
+
+    /**
+      * @brief the path of the written file, used in error reports
+      *
+      */
+    QString path;
+
+    /**
+      * @brief the written file
+      *
+      */
+    FILE* file;
+
+    /**
+      * @brief libpng write structure
+      *
+      */
+    png_structp png;
+
+    /**
+      * @brief libpng info structure
+      *
+      */
+    png_infop info;
+
+    /**
+      * @brief width of the image in pixels
+      *
+      */
+    int width;
+
+    /**
+      * @brief number of rows still to be written
+      *
+      */
+    int remainingRows;
+
+};
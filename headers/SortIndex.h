@@ -0,0 +1,132 @@
+#pragma once
+#include <QHash>
+#include <QLineF>
+#include <QRectF>
+#include <QVector>
+
+/**
+  * @file SortIndex.h
+  * @brief header for the SortIndex class
+  *
+  */
+
+class GSort;
+
+
+/**
+  * @class SortIndex
+  * @brief spatial index of the rectangles of the sorts of a scene
+  * @details the rectangles, enlarged by padding, are bucketed in square cells of cellSize pixels, so that looking for
+  * the sorts around a point, in a rectangle or along a line costs the number of cells covered instead of the number
+  * of sorts. The index is kept up to date by the sorts themselves when they move or change orientation.
+  *
+  */
+class SortIndex {
+
+  public:
+
+    /**
+      * @brief width (and height) of the cells, in pixels
+      *
+      */
+    static const qreal cellSize;
+
+    /**
+      * @brief margin added around the rectangle of each sort, so that the sorts closer than padding to a rectangle
+      * or to a line are found as well
+      *
+      */
+    static const qreal padding;
+
+    /**
+      * @brief number of rings of positions, padding apart, looked at by freeSpot around a rectangle
+      *
+      */
+    static const int maxRings;
+
+    /**
+      * @brief adds a sort to the index, with its current rectangle
+      * @param GSort* the sort
+      *
+      */
+    void insert(GSort* s);
+
+    /**
+      * @brief removes a sort from the index
+      * @param GSort* the sort
+      *
+      */
+    void remove(GSort* s);
+
+    /**
+      * @brief moves a sort of the index to its current rectangle
+      * @param GSort* the sort
+      *
+      */
+    void update(GSort* s);
+
+    /**
+      * @brief removes all the sorts from the index
+      *
+      */
+    void clear();
+
+    /**
+      * @brief gives the sorts whose enlarged rectangle intersects a given rectangle
+      * @param QRectF the rectangle, in scene coordinates
+      * @return QVector<GSort*> the sorts, each one once
+      *
+      */
+    QVector<GSort*> inRect(const QRectF& area) const;
+
+    /**
+      * @brief gives the sorts whose enlarged rectangle may be crossed by a segment
+      * @details only the cells the segment goes through are looked at
+      * @param QLineF the segment, in scene coordinates
+      * @return QVector<GSort*> the sorts, each one once
+      *
+      */
+    QVector<GSort*> alongLine(const QLineF& line) const;
+
+    /**
+      * @brief tells whether a rectangle is farther than padding from all the sorts
+      * @details a sort is in the way if its rectangle, enlarged by padding on each side, intersects the given one:
+      * the gaps between them along x and along y are both less than padding (GSort::defaultDistance)
+      * @param QRectF the rectangle, in scene coordinates
+      * @param GSort* a sort not to take into account, usually the one the rectangle is for
+      * @return bool true if no other sort is closer than padding
+      *
+      */
+    bool isFree(const QRectF& r, const GSort* except = 0) const;
+
+    /**
+      * @brief gives the free position of a rectangle the nearest to it
+      * @details the positions are looked at on square rings of increasing size, padding apart, around the rectangle
+      * @param QRectF the rectangle, in scene coordinates
+      * @param GSort* a sort not to take into account, usually the one the rectangle is for
+      * @param int the number of rings looked at
+      * @return QRectF the rectangle moved to the free position, null if there is none within the rings
+      *
+      */
+    QRectF freeSpot(const QRectF& r, const GSort* except = 0, int rings = maxRings) const;
+
+    /**
+      * @brief gives the rectangle of a sort as known by the index, enlarged by padding
+      * @param GSort* the sort
+      * @return QRectF the rectangle, null if the sort is not in the index
+      *
+      */
+    QRectF rect(GSort* s) const;
+
+  private:
+
+    static quint64 key(int i, int j);
+
+    void addToCells(GSort* s, const QRectF& r);
+
+    void removeFromCells(GSort* s, const QRectF& r);
+
+    QHash<quint64, QVector<GSort*> > cells;
+
+    QHash<GSort*, QRectF> rects;
+};
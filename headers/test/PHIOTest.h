@@ -8,11 +8,13 @@
 
 /**
   * @class PHIOTest
-  * @brief checks that PH files are parsed successfully
+  * @brief checks that PH files are parsed successfully, and that layouts are saved and restored
   */
 class PHIOTest: public QObject {
     Q_OBJECT
   private slots:
     void parse_data();
     void parse();
+    void binaryLayout();
+    void binaryLayoutRejected();
 };
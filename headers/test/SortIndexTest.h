@@ -0,0 +1,20 @@
+#include <QtTest/QtTest>
+
+/**
+  * @file SortIndexTest.h
+  * @brief header for the SortIndexTest class
+  */
+
+/**
+  * @class SortIndexTest
+  * @brief checks the lookups of the spatial index of the sorts
+  */
+class SortIndexTest: public QObject {
+    Q_OBJECT
+  private slots:
+    void inRect();
+    void alongLine();
+    void update();
+    void isFree();
+    void freeSpot();
+};
@@ -1,16 +1,181 @@
-#include <string>
+/*!
+ * @file Main2.cpp
+ * @brief Headless batch program (gph-batch)
+ * @details Lays out PH files and exports them without opening any window:
+ *
+ *     gph-batch [-j jobs] [-f png,svg,dot,ph] [-l algorithm] [-o directory] file.ph...
+ *
+ * Graphviz and the graphics scene cannot be shared between threads, so the files are
+ * spread over a pool of worker processes, each of them being gph-batch itself run with -j 1.
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QQueue>
+#include <QThread>
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include "Exceptions.h"
 #include "IO.h"
+#include "LayoutStrategy.h"
 #include "PHIO.h"
 #include "PH.h"
 
-using name space std;
+using std::cerr;
+using std::endl;
+
+// parse, lay out and export one file, in this process
+static bool exportFile(const QString& file, const QStringList& formats, const QString& outputDir) {
+
+    QFileInfo info(file);
+    QString base = QDir(outputDir.isEmpty() ? info.absolutePath() : outputDir).filePath(info.completeBaseName());
+
+    try {
+        PHPtr ph = PHIO::parseFile(file.toStdString());
+        ph->render();
+
+        for (const QString& format : formats) {
+            if (format == "png")
+                PHIO::exportToPNG(ph, base + ".png");
+            else if (format == "svg")
+                PHIO::exportToSVG(ph, base + ".svg");
+            else if (format == "dot")
+                IO::writeFile((base + ".dot").toStdString(), ph->toDotString());
+            else if (format == "ph")
+                PHIO::writeToFile((base + ".ph").toStdString(), ph);
+        }
+
+    } catch (pint_program_not_found&) {
+        cerr << "gph-batch: " << file.toStdString() << ": phc not found" << endl;
+        return false;
+    } catch (pint_phc_crash& e) {
+        const string* info = boost::get_error_info<parse_info>(e);
+        cerr << "gph-batch: " << file.toStdString() << ": phc failed" << (info ? ": " + *info : string()) << endl;
+        return false;
+    } catch (exception_base& e) {
+        const string* path = boost::get_error_info<file_info>(e);
+        cerr << "gph-batch: " << file.toStdString() << ": " << (path ? "unable to write " + *path : string("unable to export")) << endl;
+        return false;
+    }
+
+    cerr << "gph-batch: " << file.toStdString() << ": done" << endl;
+    return true;
+}
 
 int main(int argc, char *argv[]) {
-    string filename;
-    cout << "Filename=";
-    cin >> filename;
-    PHPtr ph = PHIO::parseFile  (filename);
-    PHIO::exportToPNG (ph, "output.png");
-    return 0;
+
+    // the scene needs a QApplication, but no display
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("gph-batch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Lays out PH files and exports them without opening any window.");
+    parser.addHelpOption();
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Number of worker processes (default: number of cores).", "jobs",
+                                  QString::number(QThread::idealThreadCount()));
+    QCommandLineOption formatsOption(QStringList() << "f" << "formats", "Comma-separated list of output formats among png, svg, dot and ph (default: png).",
+                                     "formats", "png");
+    QCommandLineOption layoutOption(QStringList() << "l" << "layout", "Layout algorithm among " + LayoutStrategy::names().join(", ") + " (default: auto).",
+                                    "algorithm", "auto");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Directory of the exported files (default: next to each input file).", "directory");
+    parser.addOption(jobsOption);
+    parser.addOption(formatsOption);
+    parser.addOption(layoutOption);
+    parser.addOption(outputOption);
+    parser.addPositionalArgument("files", "PH files to export.", "file.ph...");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    const QStringList formats = parser.value(formatsOption).toLower().split(',', QString::SkipEmptyParts);
+    const QString outputDir = parser.value(outputOption);
+    bool ok;
+    int jobs = parser.value(jobsOption).toInt(&ok);
+
+    if (files.isEmpty())
+        parser.showHelp(1);
+    if (!ok || jobs < 1) {
+        cerr << "gph-batch: invalid number of jobs" << endl;
+        return 1;
+    }
+    for (const QString& format : formats) {
+        if (format != "png" && format != "svg" && format != "dot" && format != "ph") {
+            cerr << "gph-batch: unknown format " << format.toStdString() << endl;
+            return 1;
+        }
+    }
+    bool knownLayout;
+    LayoutStrategy::setDefault(LayoutStrategy::fromName(parser.value(layoutOption), &knownLayout));
+    if (!knownLayout) {
+        cerr << "gph-batch: unknown layout algorithm " << parser.value(layoutOption).toStdString() << endl;
+        return 1;
+    }
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir)) {
+        cerr << "gph-batch: unable to create " << outputDir.toStdString() << endl;
+        return 1;
+    }
+
+    // worker: export the files one after the other
+    jobs = std::min(jobs, files.size());
+    if (jobs == 1) {
+        int status = 0;
+        for (const QString& file : files)
+            if (!exportFile(file, formats, outputDir))
+                status = 1;
+        return status;
+    }
+
+    // master: hand the files over to at most jobs workers at a time, one file per worker
+    QQueue<QString> pending;
+    for (const QString& file : files)
+        pending.enqueue(file);
+    int running = 0;
+    int status = 0;
+
+    std::function<void()> startNext = [&]() {
+        if (pending.isEmpty()) {
+            if (running == 0)
+                app.exit(status);
+            return;
+        }
+
+        QStringList args;
+        args << "-j" << "1" << "-f" << formats.join(',') << "-l" << parser.value(layoutOption);
+        if (!outputDir.isEmpty())
+            args << "-o" << outputDir;
+        args << pending.dequeue();
+
+        QProcess* worker = new QProcess(&app);
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        QObject::connect(worker, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                         [&, worker](int exitCode, QProcess::ExitStatus exitStatus) {
+            if (exitStatus != QProcess::NormalExit || exitCode != 0)
+                status = 1;
+            running--;
+            worker->deleteLater();
+            startNext();
+        });
+        running++;
+        worker->start(QCoreApplication::applicationFilePath(), args);
+        if (!worker->waitForStarted()) {
+            cerr << "gph-batch: unable to start a worker" << endl;
+            running--;
+            status = 1;
+            worker->deleteLater();
+            pending.clear();
+            // the other workers may all be done already: nothing else would end the event loop
+            if (running == 0)
+                app.exit(status);
+        }
+    };
+
+    for (int i = 0; i < jobs && !pending.isEmpty(); i++)
+        startNext();
+
+    return running == 0 ? status : app.exec();
 }
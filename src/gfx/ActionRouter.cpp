@@ -0,0 +1,91 @@
+#include <QLineF>
+#include <QVarLengthArray>
+#include <QtCore/qmath.h>
+#include <algorithm>
+#include "ActionRouter.h"
+#include "GSort.h"
+
+const qreal ActionRouter::margin = GSort::marginDefault;
+const int ActionRouter::maxDetours = 8;
+
+namespace {
+
+// parameter, between 0 and 1, at which a segment enters a rectangle (Liang-Barsky), or a negative value if it does not
+qreal entryOf(const QLineF& segment, const QRectF& r) {
+    qreal t0 = 0, t1 = 1;
+    const qreal p[4] = { -segment.dx(), segment.dx(), -segment.dy(), segment.dy() };
+    const qreal q[4] = { segment.x1() - r.left(), r.right() - segment.x1(), segment.y1() - r.top(), r.bottom() - segment.y1() };
+    for (int k = 0; k < 4; k++) {
+        if (p[k] == 0) {
+            if (q[k] < 0) return -1;
+            continue;
+        }
+        qreal t = q[k] / p[k];
+        if (p[k] < 0)
+            t0 = std::max(t0, t);
+        else
+            t1 = std::min(t1, t);
+        if (t0 > t1) return -1;
+    }
+    return t0;
+}
+
+}
+
+QVector<QPointF> ActionRouter::route(const SortIndex& index, const QPointF& from, const QPointF& to, const GSort* source, const GSort* target) {
+    QVector<QPointF> points;
+    points << from;
+    QVarLengthArray<const GSort*, 8> passed;
+    QPointF current = from;
+
+    for (int d = 0; d < maxDetours; d++) {
+        QLineF segment(current, to);
+        if (segment.length() == 0) break;
+
+        // the first sort in the way, if any
+        const GSort* obstacle = 0;
+        QRectF obstacleRect;
+        qreal first = 2;
+        for (GSort* s : index.alongLine(segment)) {
+            if (s == source || s == target || !s->isVisible() || std::find(passed.begin(), passed.end(), s) != passed.end())
+                continue;
+            QRectF r = s->getSceneRect().adjusted(-margin, -margin, margin, margin);
+            qreal t = entryOf(segment, r);
+            if (t >= 0 && t < first) {
+                first = t;
+                obstacle = s;
+                obstacleRect = r;
+            }
+        }
+        if (!obstacle) break;
+        passed.append(obstacle);
+
+        // the detour goes along the side of the sort opposite to its center
+        QPointF direction = (to - current) / segment.length();
+        QPointF normal(-direction.y(), direction.x());
+        QPointF center = obstacleRect.center();
+        if (QPointF::dotProduct(center - current, normal) > 0)
+            normal = -normal;
+        qreal extent = qAbs(normal.x())*obstacleRect.width()/2 + qAbs(normal.y())*obstacleRect.height()/2;
+        current = center + normal*extent;
+        points << current;
+    }
+
+    points << to;
+    return points;
+}
+
+void ActionRouter::addRoute(QPainterPath& path, const QVector<QPointF>& route) {
+    const int n = route.size();
+    if (n <= 2) {
+        path.lineTo(route.last());
+        return;
+    }
+    for (int i = 0; i + 1 < n; i++) {
+        const QPointF& p0 = route[std::max(i - 1, 0)];
+        const QPointF& p1 = route[i];
+        const QPointF& p2 = route[i + 1];
+        const QPointF& p3 = route[std::min(i + 2, n - 1)];
+        path.cubicTo(p1 + (p2 - p0)/6, p2 - (p3 - p1)/6, p2);
+    }
+}
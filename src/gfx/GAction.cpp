@@ -1,5 +1,5 @@
 #include <iostream>
-#include <QMatrix>
+#include <QTransform>
 #include <QPointF>
 #include <QVector>
 #include <QColor>
@@ -7,7 +7,10 @@
 #include <QApplication>
 #include <QMenu>
 #include <QVector2D>
+#include "ActionRouter.h"
 #include "GAction.h"
+#include "GActionLayer.h"
+#include "LevelOfDetail.h"
 #include <QtCore/qmath.h>
 
 #include <QPen>
@@ -15,54 +18,145 @@
 #include <QtGui>
 
 
-GAction::GAction(ActionPtr a, PHScene* sc) : scene(sc), action(a) {
-    display = new QGraphicsItemGroup();
+namespace {
+
+// hit drawn as a straight line, without its arrowhead, when zoomed out
+class HitItem : public QGraphicsPathItem {
+
+  public:
+    HitItem(GAction* a, const QPainterPath& path, QGraphicsItem* parent) : QGraphicsPathItem(path, parent), owner(a) {}
+
+    // zoomed out, the hit is drawn between the centers of the sorts, which may lie out of its path
+    QRectF boundingRect() const {
+        const qreal w = pen().widthF();
+        const QLineF l = owner->getStraightHit();
+        return QGraphicsPathItem::boundingRect() | QRectF(l.p1(), l.p2()).normalized().adjusted(-w, -w, w, w);
+    }
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+        if (LevelOfDetail::of(option, painter) < LevelOfDetail::action) {
+            painter->setPen(pen());
+            painter->drawLine(owner->getStraightHit());
+            return;
+        }
+        QGraphicsPathItem::paint(painter, option, widget);
+    }
+
+  private:
+    GAction* owner;
+};
+
+}
+
+GAction::GAction(ActionPtr a, PHScene* sc) : scene(sc), display(0), hitLine(0), boundArc(0), action(a), layer(0), layerIndex(-1) {
+
+    resolve();
 
     initContactPoints();
 
-    hitLine= new QGraphicsPathItem(createHitPath(),display);
-    if((targetPoint->x()==resultPoint->x())&&(targetPoint->y()==resultPoint->y())) {
+    // the paths of the actions of a culled scene are made once they come near the viewport, see PHScene::setViewport
+    laidOut = !scene->isCulled();
+    if (laidOut) {
+        hitPath = createHitPath();
+        boundPath = createBoundPath();
+    }
+    if((targetPoint.x()==resultPoint.x())&&(targetPoint.y()==resultPoint.y())) {
         QPen pen;
         pen.setWidth(2);
         pen.setBrush(Qt::red);
-        hitLine->setPen(pen);
+        hitPen = pen;
     } else {
         QPen pen;
         pen.setWidth(1);
         pen.setBrush(Qt::black);
-        hitLine->setPen(pen);
+        hitPen = pen;
     }
 
-    boundArc = new QGraphicsPathItem(createBoundPath(),display);
-    boundArc->setPen(QPen(Qt::DashLine));
+    boundPen = QPen(Qt::DashLine);
     numberActionColor=-1;
     this->bold=false;
+    this->dirty=false;
+    this->visible=true;
 
 }
 
+void GAction::createItems() {
+    if (display) return;
+    layOut();
+    display = new QGraphicsItemGroup();
+    hitLine = new HitItem(this, hitPath, display);
+    hitLine->setPen(hitPen);
+    boundArc = new LodItem<QGraphicsPathItem>(LevelOfDetail::action, boundPath, display);
+    boundArc->setPen(boundPen);
+    display->setVisible(visible);
+}
+
 void GAction::update() {
 
     updateContactPoints();
     QPen pen;
 
-    boundArc->setPath(createBoundPath());
-    hitLine->setPath(createHitPath());
-    if((targetPoint->x()==resultPoint->x())&&(targetPoint->y()==resultPoint->y())) {
+    if (laidOut)
+        setPaths(createHitPath(), createBoundPath());
+    if((targetPoint.x()==resultPoint.x())&&(targetPoint.y()==resultPoint.y())) {
         pen.setWidth(2);
         pen.setBrush(Qt::red);
-        hitLine->setPen(pen);
+        setHitPen(pen);
     } else {
         if (this->isBold())
             pen.setWidth(2);
         else
             pen.setWidth(1);
         pen.setBrush(Qt::black);
-        hitLine->setPen(pen);
+        setHitPen(pen);
         pen.setStyle(Qt::DashLine);
-        boundArc->setPen(pen);
+        setBoundPen(pen);
+    }
+    changed();
+}
+
+void GAction::layOut() {
+    if (laidOut) return;
+    updateContactPoints();
+    laidOut = true;
+    setPaths(createHitPath(), createBoundPath());
+    changed();
+}
+
+void GAction::release() {
+    // the items of an action are drawn from its paths, which it then keeps
+    if (!laidOut || display) return;
+    laidOut = false;
+    hitPath = QPainterPath();
+    boundPath = QPainterPath();
+    changed();
+}
+
+bool GAction::isLaidOut() {
+    return laidOut;
+}
+
+void GAction::setPaths(const QPainterPath& hit, const QPainterPath& bound) {
+    hitPath = hit;
+    boundPath = bound;
+    if (display) {
+        hitLine->setPath(hit);
+        boundArc->setPath(bound);
     }
 }
 
+void GAction::setHitPen(const QPen& pen) {
+    hitPen = pen;
+    if (display)
+        hitLine->setPen(pen);
+}
+
+void GAction::setBoundPen(const QPen& pen) {
+    boundPen = pen;
+    if (display)
+        boundArc->setPen(pen);
+}
+
 GAction::GAction() {
 }
 
@@ -71,10 +165,17 @@ GAction::~GAction() {
     delete display;
 }
 
-void GAction::initContactPoints() {
-    GSortPtr sourceSort = scene->getGSort(action->getSource()->getSort()->getName());
-    GSortPtr targetSort = scene->getGSort(action->getTarget()->getSort()->getName());
+// the sorts and processes of the action, looked up once instead of on every update
+void GAction::resolve() {
+    sourceSort = scene->getGSort(action->getSource()->getSort()->getName()).get();
+    targetSort = scene->getGSort(action->getTarget()->getSort()->getName()).get();
+    resultSort = scene->getGSort(action->getResult()->getSort()->getName()).get();
+    source = action->getSource()->getGProcess().get();
+    target = action->getTarget()->getGProcess().get();
+    result = action->getResult()->getGProcess().get();
+}
 
+void GAction::initContactPoints() {
     if(sourceSort->getSimpleDisplay()!=1||targetSort->getSimpleDisplay()!=1) {
         initPointsInDetailledModel();
     } else {
@@ -83,10 +184,6 @@ void GAction::initContactPoints() {
 }
 
 void GAction::updateContactPoints() {
-
-    GSortPtr sourceSort = scene->getGSort(action->getSource()->getSort()->getName());
-    GSortPtr targetSort = scene->getGSort(action->getTarget()->getSort()->getName());
-
     if(sourceSort->getSimpleDisplay()!=1||targetSort->getSimpleDisplay()!=1) {
         updatePointsInDetailledModel();
     } else {
@@ -95,12 +192,9 @@ void GAction::updateContactPoints() {
 }
 
 void GAction::initPointsInSimpleModele() {
-    GSortPtr sourceSort = scene->getGSort(action->getSource()->getSort()->getName());
-    GSortPtr targetSort = scene->getGSort(action->getTarget()->getSort()->getName());
-
-    sourcePoint = new QPointF(sourceSort->getCenterPoint());
-    targetPoint = new QPointF(targetSort->getCenterPoint());
-    resultPoint = new QPointF(targetSort->getCenterPoint());
+    sourcePoint = QPointF(sourceSort->getCenterPoint());
+    targetPoint = QPointF(targetSort->getCenterPoint());
+    resultPoint = QPointF(targetSort->getCenterPoint());
 
 }
 
@@ -109,16 +203,12 @@ void GAction::initPointsInDetailledModel() {
 }
 
 void GAction::updatePointsInSimpleModel() {
-
-    GSortPtr sourceSort = scene->getGSort(action->getSource()->getSort()->getName());
-    GSortPtr targetSort = scene->getGSort(action->getTarget()->getSort()->getName());
-
-    sourcePoint->setX(sourceSort->getCenterPoint().x());
-    sourcePoint->setY(sourceSort->getCenterPoint().y());
-    targetPoint->setX(targetSort->getCenterPoint().x());
-    targetPoint->setY(targetSort->getCenterPoint().y());
-    resultPoint->setX(targetSort->getCenterPoint().x());
-    resultPoint->setY(targetSort->getCenterPoint().y());
+    sourcePoint.setX(sourceSort->getCenterPoint().x());
+    sourcePoint.setY(sourceSort->getCenterPoint().y());
+    targetPoint.setX(targetSort->getCenterPoint().x());
+    targetPoint.setY(targetSort->getCenterPoint().y());
+    resultPoint.setX(targetSort->getCenterPoint().x());
+    resultPoint.setY(targetSort->getCenterPoint().y());
 
 }
 
@@ -127,133 +217,96 @@ void GAction::updatePointsInDetailledModel() {
 }
 
 bool GAction::isAutoHit() {
-    GProcessPtr source = getSource();
-    GProcessPtr target = getTarget();
-
     return source==target;
 }
 
 void GAction::initPointsNormalHit() {
-    GProcessPtr source = getSource();
-    GProcessPtr target = getTarget();
-    GProcessPtr result = getResult();
-
-    QVector2D* hitVector = new QVector2D(*(target->getCenterPoint()) - *(source->getCenterPoint()));
-    hitVector->normalize();
+    QVector2D hitVector(*(target->getCenterPoint()) - *(source->getCenterPoint()));
+    hitVector.normalize();
 
     QSizeF* sizeSource = source->getSizeEllipse();
     QSizeF* sizeTarget = source->getSizeEllipse();
 
 
-    sourcePoint = new QPointF(sizeSource->width()*hitVector->x()/2.0 + source->getCenterPoint()->x(),sizeSource->height()*hitVector->y()/2 + source->getCenterPoint()->y());
+    sourcePoint = QPointF(sizeSource->width()*hitVector.x()/2.0 + source->getCenterPoint()->x(),sizeSource->height()*hitVector.y()/2 + source->getCenterPoint()->y());
 
-    targetPoint = new QPointF(-sizeTarget->width()*hitVector->x()/2.0 + target->getCenterPoint()->x(),-sizeTarget->height()*hitVector->y()/2 + target->getCenterPoint()->y());
+    targetPoint = QPointF(-sizeTarget->width()*hitVector.x()/2.0 + target->getCenterPoint()->x(),-sizeTarget->height()*hitVector.y()/2 + target->getCenterPoint()->y());
 
-    resultPoint = new QPointF(-sizeTarget->width()*hitVector->x()/2.0 + result->getCenterPoint()->x(),sizeTarget->height()*hitVector->y()/2 + result->getCenterPoint()->y());
+    resultPoint = QPointF(-sizeTarget->width()*hitVector.x()/2.0 + result->getCenterPoint()->x(),sizeTarget->height()*hitVector.y()/2 + result->getCenterPoint()->y());
 
 }
 
 void GAction::updatePointsNormalHit() {
-    GProcessPtr source = getSource();
-    GProcessPtr target = getTarget();
-    GProcessPtr result = getResult();
-
-    QVector2D* hitVector = new QVector2D(*(target->getCenterPoint()) - *(source->getCenterPoint()));
-    hitVector->normalize();
+    QVector2D hitVector(*(target->getCenterPoint()) - *(source->getCenterPoint()));
+    hitVector.normalize();
 
     QSizeF* sizeSource = source->getSizeEllipse();
     QSizeF* sizeTarget = target->getSizeEllipse();
 
-    sourcePoint->setX(sizeSource->width()*hitVector->x()/2.0 + source->getCenterPoint()->x());
-    sourcePoint->setY(sizeSource->height()*hitVector->y()/2.0 + source->getCenterPoint()->y());
-    targetPoint->setX(-sizeTarget->width()*hitVector->x()/2.0 + target->getCenterPoint()->x());
-    targetPoint->setY(-sizeTarget->height()*hitVector->y()/2.0 + target->getCenterPoint()->y());
+    sourcePoint.setX(sizeSource->width()*hitVector.x()/2.0 + source->getCenterPoint()->x());
+    sourcePoint.setY(sizeSource->height()*hitVector.y()/2.0 + source->getCenterPoint()->y());
+    targetPoint.setX(-sizeTarget->width()*hitVector.x()/2.0 + target->getCenterPoint()->x());
+    targetPoint.setY(-sizeTarget->height()*hitVector.y()/2.0 + target->getCenterPoint()->y());
 
-    if(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical()) {
-        resultPoint->setX(-sizeTarget->width()*hitVector->x()/2.0 + result->getCenterPoint()->x());
-        resultPoint->setY(sizeTarget->height()*hitVector->y()/2.0 + result->getCenterPoint()->y());
+    if(targetSort->isVertical()) {
+        resultPoint.setX(-sizeTarget->width()*hitVector.x()/2.0 + result->getCenterPoint()->x());
+        resultPoint.setY(sizeTarget->height()*hitVector.y()/2.0 + result->getCenterPoint()->y());
     } else {
-        resultPoint->setX(sizeTarget->width()*hitVector->x()/2.0 + result->getCenterPoint()->x());
-        resultPoint->setY(-sizeTarget->height()*hitVector->y()/2.0 + result->getCenterPoint()->y());
+        resultPoint.setX(sizeTarget->width()*hitVector.x()/2.0 + result->getCenterPoint()->x());
+        resultPoint.setY(-sizeTarget->height()*hitVector.y()/2.0 + result->getCenterPoint()->y());
     }
 }
 
 void GAction::initPointsAutoHit() {
-    GProcessPtr source = getSource();
-    GProcessPtr target = getTarget();
-    GProcessPtr result = getResult();
-
-    if (dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical()) {
-        sourcePoint = new QPointF(source->getCenterPoint()->x(), source->getCenterPoint()->y() + (GProcess::sizeDefault)/2.0);
-        targetPoint = new QPointF(GProcess::sizeDefault/2.0 + source->getCenterPoint()->x(), source->getCenterPoint()->y());
-        resultPoint = new QPointF(GProcess::sizeDefault/2.0 + result->getCenterPoint()->x(),result->getCenterPoint()->y());
+    if (targetSort->isVertical()) {
+        sourcePoint = QPointF(source->getCenterPoint()->x(), source->getCenterPoint()->y() + (GProcess::sizeDefault)/2.0);
+        targetPoint = QPointF(GProcess::sizeDefault/2.0 + source->getCenterPoint()->x(), source->getCenterPoint()->y());
+        resultPoint = QPointF(GProcess::sizeDefault/2.0 + result->getCenterPoint()->x(),result->getCenterPoint()->y());
     } else {
-        sourcePoint = new QPointF(source->getCenterPoint()->x() + (GProcess::sizeDefault)/2.0, source->getCenterPoint()->y());
-        targetPoint = new QPointF(source->getCenterPoint()->x(),GProcess::sizeDefault/2.0 + source->getCenterPoint()->y());
-        resultPoint = new QPointF(result->getCenterPoint()->x(),GProcess::sizeDefault/2.0 + result->getCenterPoint()->y());
+        sourcePoint = QPointF(source->getCenterPoint()->x() + (GProcess::sizeDefault)/2.0, source->getCenterPoint()->y());
+        targetPoint = QPointF(source->getCenterPoint()->x(),GProcess::sizeDefault/2.0 + source->getCenterPoint()->y());
+        resultPoint = QPointF(result->getCenterPoint()->x(),GProcess::sizeDefault/2.0 + result->getCenterPoint()->y());
     }
 
 }
 
 void GAction::updatePointsAutoHit() {
-    GProcessPtr source = getSource();
-    GProcessPtr target = getTarget();
-    GProcessPtr result = getResult();
-
-    if(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical()) {
-        sourcePoint->setX(source->getCenterPoint()->x());
-        sourcePoint->setY(source->getCenterPoint()->y() + (GProcess::sizeDefault)/2.0);
-        targetPoint->setX(GProcess::sizeDefault/2 + source->getCenterPoint()->x());
-        targetPoint->setY(source->getCenterPoint()->y());
-        resultPoint->setX(GProcess::sizeDefault/2 + result->getCenterPoint()->x());
-        resultPoint->setY(result->getCenterPoint()->y());
+    if(targetSort->isVertical()) {
+        sourcePoint.setX(source->getCenterPoint()->x());
+        sourcePoint.setY(source->getCenterPoint()->y() + (GProcess::sizeDefault)/2.0);
+        targetPoint.setX(GProcess::sizeDefault/2 + source->getCenterPoint()->x());
+        targetPoint.setY(source->getCenterPoint()->y());
+        resultPoint.setX(GProcess::sizeDefault/2 + result->getCenterPoint()->x());
+        resultPoint.setY(result->getCenterPoint()->y());
     } else {
-        sourcePoint->setX(source->getCenterPoint()->x() + (GProcess::sizeDefault)/2.0);
-        sourcePoint->setY(source->getCenterPoint()->y());
-        targetPoint->setX(source->getCenterPoint()->x());
-        targetPoint->setY(source->getCenterPoint()->y() + GProcess::sizeDefault/2);
-        resultPoint->setX(result->getCenterPoint()->x());
-        resultPoint->setY(result->getCenterPoint()->y() + GProcess::sizeDefault/2);
+        sourcePoint.setX(source->getCenterPoint()->x() + (GProcess::sizeDefault)/2.0);
+        sourcePoint.setY(source->getCenterPoint()->y());
+        targetPoint.setX(source->getCenterPoint()->x());
+        targetPoint.setY(source->getCenterPoint()->y() + GProcess::sizeDefault/2);
+        resultPoint.setX(result->getCenterPoint()->x());
+        resultPoint.setY(result->getCenterPoint()->y() + GProcess::sizeDefault/2);
     }
 }
-bool GAction::isCurvedHit(GSortPtr sourceSort, GSortPtr targetSort, GProcessPtr source, GProcessPtr target) {
-
-    QLineF* hitLineTemp;
-
-    QLineF* sourceSortBottomLine;
-    QLineF* sourceSortTopLine;
-    QPointF sourceSortBottomLeft = sourceSort->getRect()->rect().bottomLeft();
-    QPointF sourceSortBottomRight = sourceSort->getRect()->rect().bottomRight();
-    QPointF sourceSortTopLeft = sourceSort->getRect()->rect().topLeft();
-    QPointF sourceSortTopRight = sourceSort->getRect()->rect().topRight();
-
-    QLineF* targetSortBottomLine;
-    QLineF* targetSortTopLine;
-    QPointF targetSortBottomLeft = targetSort->getRect()->rect().bottomLeft();
-    QPointF targetSortBottomRight = targetSort->getRect()->rect().bottomRight();
-    QPointF targetSortTopLeft = targetSort->getRect()->rect().topLeft();
-    QPointF targetSortTopRight = targetSort->getRect()->rect().topRight();
-
-    hitLineTemp = new QLineF(*sourcePoint,*targetPoint);
-    sourceSortBottomLine = new QLineF(sourceSortBottomLeft,sourceSortBottomRight);
-    sourceSortTopLine= new QLineF(sourceSortTopLeft,sourceSortTopRight);
-    const QLineF & refToSourceSortBottomLine = *sourceSortBottomLine ;// built a reference to the QLinef* associate because of the function intersect() used after, which whants only reference and no pointer
-    const QLineF & refToSourceSortTopLine = *sourceSortTopLine ;// built a reference to the QLinef* associate because of the function intersect() used after, which whants only reference and no pointer
-
-    targetSortBottomLine = new QLineF(targetSortBottomLeft,targetSortBottomRight);
-    targetSortTopLine = new QLineF(targetSortTopLeft,targetSortTopRight);
-    const QLineF & refToTargetSortBottomLine = *targetSortBottomLine ;// built a reference to the QLinef* associate because of the function intersect() used after, which whants only reference and no pointer
-    const QLineF & refToTargetSortTopLine = *targetSortTopLine ;// built a reference to the QLinef* associate because of the function intersect() used after, which whants only reference and no pointer
-
-    if((hitLineTemp->intersect(refToSourceSortBottomLine, 0) == QLineF::BoundedIntersection &&
-        source->getCenterPoint()->y() + GProcess::sizeDefault < sourceSort->getRect()->rect().bottomLeft().y()) ||
-        (hitLineTemp->intersect(refToSourceSortTopLine, 0) == QLineF::BoundedIntersection &&
-         source->getCenterPoint()->y() - GProcess::sizeDefault > sourceSort->getRect()->rect().topLeft().y())) {
+bool GAction::isCurvedHit() {
+
+    const QRectF sourceRect = sourceSort->getRect()->rect();
+    const QRectF targetRect = targetSort->getRect()->rect();
+
+    const QLineF hitLineTemp(sourcePoint,targetPoint);
+    const QLineF sourceSortBottomLine(sourceRect.bottomLeft(),sourceRect.bottomRight());
+    const QLineF sourceSortTopLine(sourceRect.topLeft(),sourceRect.topRight());
+    const QLineF targetSortBottomLine(targetRect.bottomLeft(),targetRect.bottomRight());
+    const QLineF targetSortTopLine(targetRect.topLeft(),targetRect.topRight());
+
+    if((hitLineTemp.intersect(sourceSortBottomLine, 0) == QLineF::BoundedIntersection &&
+        source->getCenterPoint()->y() + GProcess::sizeDefault < sourceRect.bottomLeft().y()) ||
+        (hitLineTemp.intersect(sourceSortTopLine, 0) == QLineF::BoundedIntersection &&
+         source->getCenterPoint()->y() - GProcess::sizeDefault > sourceRect.topLeft().y())) {
         return true;
-    } else if((hitLineTemp->intersect(refToTargetSortBottomLine, 0) == QLineF::BoundedIntersection &&
-               target->getCenterPoint()->y() + GProcess::sizeDefault < targetSort->getRect()->rect().bottomLeft().y()) ||
-              (hitLineTemp->intersect(refToTargetSortTopLine, 0) == QLineF::BoundedIntersection &&
-               target->getCenterPoint()->y() - GProcess::sizeDefault > targetSort->getRect()->rect().topLeft().y())) {
+    } else if((hitLineTemp.intersect(targetSortBottomLine, 0) == QLineF::BoundedIntersection &&
+               target->getCenterPoint()->y() + GProcess::sizeDefault < targetRect.bottomLeft().y()) ||
+              (hitLineTemp.intersect(targetSortTopLine, 0) == QLineF::BoundedIntersection &&
+               target->getCenterPoint()->y() - GProcess::sizeDefault > targetRect.topLeft().y())) {
         return true;
     } else {
         return false;
@@ -264,13 +317,6 @@ bool GAction::isCurvedHit(GSortPtr sourceSort, GSortPtr targetSort, GProcessPtr
 //Hit Part
 QPainterPath GAction::createHitPath() {
 
-    GProcessPtr source = getSource();
-    GProcessPtr target = getTarget();
-    GProcessPtr result = getResult();
-    GSortPtr sourceSort = scene->getGSort(action->getSource()->getSort()->getName());
-    GSortPtr targetSort = scene->getGSort(action->getTarget()->getSort()->getName());
-
-
     qreal rectCornerX;
     qreal rectCornerY;
     qreal widthRect;
@@ -282,66 +328,64 @@ QPainterPath GAction::createHitPath() {
     int wCoef=1;
     int hCoef=1;
 
-    QPointF* controlPointSource;
-    QPointF* controlPointTarget;
+    const QLineF hitLineTemp(sourcePoint,targetPoint);
 
-    QLineF* hitLineTemp;
-    hitLineTemp = new QLineF(*sourcePoint,*targetPoint);
-
-    QPainterPath hitPath(*sourcePoint);
+    QPainterPath hitPath(sourcePoint);
 
     if(!isAutoHit()) {
-        if(isCurvedHit(sourceSort, targetSort, source, target) && (sourceSort->getSimpleDisplay()!=1 || targetSort->getSimpleDisplay()!=1)) {
-            if(sourcePoint->x() >= targetPoint->x()) {
+        if(isCurvedHit() && (sourceSort->getSimpleDisplay()!=1 || targetSort->getSimpleDisplay()!=1)) {
+            if(sourcePoint.x() >= targetPoint.x()) {
                 wCoef= -1;
             } else {
                 wCoef= 1;
             }
-            if(sourcePoint->y() >= targetPoint->y()) {
+            if(sourcePoint.y() >= targetPoint.y()) {
                 hCoef = 1;
             } else {
                 hCoef = -1;
             }
-            controlPointSource = new QPointF(sourcePoint->x() + wCoef*hitLineTemp->length()/2.0,sourcePoint->y()-hCoef*hitLineTemp->length()/3.0);
-            controlPointTarget = new QPointF(targetPoint->x() + wCoef*hitLineTemp->length()/2.0,targetPoint->y() + hCoef*hitLineTemp->length()/3.0);
+            const qreal length = hitLineTemp.length();
+            const QPointF controlPointSource(sourcePoint.x() + wCoef*length/2.0,sourcePoint.y()-hCoef*length/3.0);
+            const QPointF controlPointTarget(targetPoint.x() + wCoef*length/2.0,targetPoint.y() + hCoef*length/3.0);
 
-            hitPath.cubicTo(*controlPointSource,*controlPointTarget, *targetPoint);
+            hitPath.cubicTo(controlPointSource,controlPointTarget, targetPoint);
         } else {
-            hitPath.lineTo(*targetPoint);
+            // go round the sorts in the way
+            ActionRouter::addRoute(hitPath, ActionRouter::route(scene->getSortIndex(), sourcePoint, targetPoint, sourceSort, targetSort));
         }
     } else if ( (isAutoHit() && sourceSort->getSimpleDisplay() != 1)
                 ||targetSort->getSimpleDisplay()!=1) {
-        if(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical() && targetPoint->y() > resultPoint->y()) {
+        if(targetSort->isVertical() && targetPoint.y() > resultPoint.y()) {
             rectCornerY = source->getCenterPoint()->y();
-            heightRect = (sourcePoint->y() - targetPoint->y())*2;
+            heightRect = (sourcePoint.y() - targetPoint.y())*2;
             invertSweep=1;
-        } else if (dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical() && targetPoint->y() < resultPoint->y()) {
-            heightRect = (targetPoint->y() - sourcePoint->y())*2;
+        } else if (targetSort->isVertical() && targetPoint.y() < resultPoint.y()) {
+            heightRect = (targetPoint.y() - sourcePoint.y())*2;
             rectCornerY = source->getCenterPoint()->y() - heightRect;
             invertSweep=-1;
-        } else if (!(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical())) {
-            heightRect = (targetPoint->y() - sourcePoint->y())*2;
+        } else if (!(targetSort->isVertical())) {
+            heightRect = (targetPoint.y() - sourcePoint.y())*2;
             rectCornerY = source->getCenterPoint()->y();
             invertSweep= -1;
         }
-        if(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical() && resultPoint->x() < getResult()->getCenterPoint()->x()) {
-            widthRect = (sourcePoint->x() - targetPoint->x())*2;
-            rectCornerX = sourcePoint->x() - widthRect;
+        if(targetSort->isVertical() && resultPoint.x() < result->getCenterPoint()->x()) {
+            widthRect = (sourcePoint.x() - targetPoint.x())*2;
+            rectCornerX = sourcePoint.x() - widthRect;
             invertStart=-1;
-        } else if (dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical() && resultPoint->x() > getResult()->getCenterPoint()->x()) {
-            rectCornerX = sourcePoint->x();
-            widthRect = (targetPoint->x() - sourcePoint->x())*2;
+        } else if (targetSort->isVertical() && resultPoint.x() > result->getCenterPoint()->x()) {
+            rectCornerX = sourcePoint.x();
+            widthRect = (targetPoint.x() - sourcePoint.x())*2;
             invertStart=1;
-        } else if(!(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical()) && resultPoint->x() < targetPoint->x()) {
+        } else if(!(targetSort->isVertical()) && resultPoint.x() < targetPoint.x()) {
             rectCornerX = source->getCenterPoint()->x();
-            widthRect = (sourcePoint->x() - targetPoint->x())*2;
+            widthRect = (sourcePoint.x() - targetPoint.x())*2;
             invertStart=-1;
-        } else if (!(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical()) && resultPoint->x() > targetPoint->x()) {
-            widthRect = (targetPoint->x() - sourcePoint->x())*2;
-            rectCornerX = sourcePoint->x() - widthRect;
+        } else if (!(targetSort->isVertical()) && resultPoint.x() > targetPoint.x()) {
+            widthRect = (targetPoint.x() - sourcePoint.x())*2;
+            rectCornerX = sourcePoint.x() - widthRect;
             invertStart=1;
         }
-        if (dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical()) {
+        if (targetSort->isVertical()) {
             startAngle = invertStart*180 ;
             sweepAngle = invertSweep*270;
         } else {
@@ -359,9 +403,9 @@ QPainterPath GAction::createHitPath() {
 }
 // Bound Part
 QPainterPath GAction::createBoundPath() {
-    QPainterPath boundPath(*targetPoint);
+    QPainterPath boundPath(targetPoint);
 
-    if((targetPoint->x()!=resultPoint->x())||(targetPoint->y()!=resultPoint->y())) {
+    if((targetPoint.x()!=resultPoint.x())||(targetPoint.y()!=resultPoint.y())) {
         qreal rectCornerX;
         qreal rectCornerY;
         qreal widthRect;
@@ -370,45 +414,45 @@ QPainterPath GAction::createBoundPath() {
         qreal startAngle;
         int invertSweep;
 
-        if(dynamic_cast<GSort*>(getTarget()->getDisplayItem()->parentItem())->isVertical()) {
-            if(targetPoint->y()<resultPoint->y()) {
-                rectCornerY = targetPoint->y();
-                heightRect = resultPoint->y()-targetPoint->y();
+        if(targetSort->isVertical()) {
+            if(targetPoint.y()<resultPoint.y()) {
+                rectCornerY = targetPoint.y();
+                heightRect = resultPoint.y()-targetPoint.y();
                 startAngle = 90;
                 invertSweep = 1;
             } else {
-                rectCornerY = resultPoint->y();
-                heightRect = targetPoint->y()-resultPoint->y();
+                rectCornerY = resultPoint.y();
+                heightRect = targetPoint.y()-resultPoint.y();
                 startAngle = -90;
                 invertSweep = -1;
             }
 
-            if(resultPoint->x() < getResult()->getCenterPoint()->x()) {
+            if(resultPoint.x() < result->getCenterPoint()->x()) {
                 sweepAngle = 180*invertSweep;
             } else {
                 sweepAngle = -180*invertSweep;
             }
 
-            rectCornerX = resultPoint->x()- (GProcess::sizeDefault)/2.0;
+            rectCornerX = resultPoint.x()- (GProcess::sizeDefault)/2.0;
             widthRect = GProcess::sizeDefault;
         } else {
 
-            if(targetPoint->x()<resultPoint->x()) { //target point à gauche de resultpoint
-                rectCornerX = targetPoint->x();
-                widthRect = resultPoint->x() - targetPoint->x();
+            if(targetPoint.x()<resultPoint.x()) { //target point à gauche de resultpoint
+                rectCornerX = targetPoint.x();
+                widthRect = resultPoint.x() - targetPoint.x();
                 startAngle =180;
                 invertSweep = -1;
             } else { //resultpoint à gauche de targetpoint
-                rectCornerX = resultPoint->x();
-                widthRect = targetPoint->x() - resultPoint->x();
+                rectCornerX = resultPoint.x();
+                widthRect = targetPoint.x() - resultPoint.x();
                 startAngle =0;
                 invertSweep = 1;
             }
-            if(resultPoint->y()<getResult()->getCenterPoint()->y()) { //resultpoint au-dessus du centre du process
-                rectCornerY = resultPoint->y()-(GProcess::sizeDefault)/2.0;
+            if(resultPoint.y()<result->getCenterPoint()->y()) { //resultpoint au-dessus du centre du process
+                rectCornerY = resultPoint.y()-(GProcess::sizeDefault)/2.0;
                 sweepAngle = 180*invertSweep;
             } else { //resultpoint en-dessus du centre du process
-                rectCornerY= resultPoint->y()-(GProcess::sizeDefault)/2.0;
+                rectCornerY= resultPoint.y()-(GProcess::sizeDefault)/2.0;
                 sweepAngle = -180*invertSweep;
             }
             heightRect = GProcess::sizeDefault;
@@ -423,37 +467,62 @@ QPainterPath GAction::createBoundPath() {
     return boundPath;
 }
 
-// draw an arrowhead
-QPolygonF GAction::makeArrowHead(QPainterPath path) {
+namespace {
 
-    // arrow pointing to the right
+// arrowhead pointing to the right, its tip on the origin
+const QPolygonF& arrowHeadTemplate() {
+    static const QPolygonF polygon(QVector<QPointF>()
+                                   << QPointF(0, 0) << QPointF(-8, -5) << QPointF(-7.5, -4)
+                                   << QPointF(-1, 0) << QPointF(-7.5, 4) << QPointF(-8, 5));
+    return polygon;
+}
+
+}
+
+// draw an arrowhead, in a buffer reused from one call to the next
+const QPolygonF& GAction::makeArrowHead(const QPainterPath& path) {
+    // the template is turned in the direction of the end of the path and moved to its end
     QPointF p = path.pointAtPercent(1);
-    QPointF* q = new QPointF(p.x() - 8, p.y() - 5);
-    QPointF* r = new QPointF(p.x() - 8, p.y() + 5);
-    QPointF* s = new QPointF(p.x() - 1, p.y());
-    QPointF* t = new QPointF(p.x() - 7.5, p.y() + 4);
-    QPointF* u = new QPointF(p.x() - 7.5, p.y() - 4);
-    QPolygonF polygon;
-    polygon.push_back(p);
-    polygon.push_back(*q);
-    polygon.push_back(*u);
-    polygon.push_back(*s);
-    polygon.push_back(*t);
-    polygon.push_back(*r);
-
-    // rotate arrow
-    QMatrix matrix;
-    matrix.translate(p.x(), p.y());
-    if(sourcePoint!=targetPoint) {
-        matrix.rotate(-path.angleAtPercent(1));
-    } else {
-        matrix.rotate(-path.angleAtPercent(0.98));
-    }
-    matrix.translate(-p.x(), -p.y());
-    polygon = matrix.map(polygon);
+    QTransform transform;
+    transform.translate(p.x(), p.y());
+    transform.rotate(-path.angleAtPercent(1));
 
-    // turn into QGraphicsPolygonItem
-    return polygon;
+    const QPolygonF& arrow = arrowHeadTemplate();
+    arrowHead.resize(arrow.size());
+    for (int i = 0; i < arrow.size(); i++)
+        arrowHead[i] = transform.map(arrow[i]);
+
+    return arrowHead;
+}
+
+bool GAction::isDirty() {
+    return dirty;
+}
+
+void GAction::setDirty(bool isDirty) {
+    dirty = isDirty;
+}
+
+void GAction::setLayer(GActionLayer* l, int index) {
+    layer = l;
+    layerIndex = index;
+}
+
+void GAction::changed() {
+    if (layer)
+        layer->actionChanged(layerIndex);
+}
+
+void GAction::setVisible(bool isVisible) {
+    if (visible == isVisible) return;
+    visible = isVisible;
+    if (display)
+        display->setVisible(isVisible);
+    changed();
+}
+
+bool GAction::isVisible() {
+    return visible;
 }
 
 //Verify if this action is in bold
@@ -467,32 +536,33 @@ void GAction::toBold() {
     if(this->isBold()) {
         pen.setWidth(1);
         pen.setBrush(Qt::black);
-        hitLine->setPen(pen);
+        setHitPen(pen);
         pen.setStyle(Qt::DashLine);
-        boundArc->setPen(pen);
+        setBoundPen(pen);
         this->bold=false;
     } else {
         pen.setWidth(2);
         pen.setBrush(Qt::black);
-        hitLine->setPen(pen);
+        setHitPen(pen);
         pen.setStyle(Qt::DashLine);
-        boundArc->setPen(pen);
+        setBoundPen(pen);
         bold=true;
     }
+    changed();
 }
 
 //Color this action
 void GAction::colorAction(QColor color) {
-
     if (!color.isValid()) {
         return ;
     } else {
         QPen pen;
         pen.setWidth(3);
         pen.setBrush(QBrush(QColor(color)));
-        hitLine->setPen(pen);
+        setHitPen(pen);
         pen.setStyle(Qt::DashLine);
-        boundArc->setPen(pen);
+        setBoundPen(pen);
+        changed();
     }
 }
 
@@ -505,9 +575,10 @@ void GAction::setActionColorNUmber(int r, int g, int b, int nb) {
     else
         pen.setWidth(2);
     pen.setBrush(QBrush(QColor(r,g,b)));
-    hitLine->setPen(pen);
+    setHitPen(pen);
     pen.setStyle(Qt::DashLine);
-    boundArc->setPen(pen);
+    setBoundPen(pen);
+    changed();
 }
 
 // getters
@@ -516,10 +587,52 @@ QGraphicsItem* GAction::getDisplayItem (void) {
     return display;
 }
 
+QPainterPath GAction::getHitPath (void) {
+    if (laidOut)
+        return hitPath;
+    updateContactPoints();
+    return createHitPath();
+}
+
+QPen GAction::getHitPen (void) {
+    return hitPen;
+}
+
+QLineF GAction::getStraightHit (void) {
+    return QLineF(sourceSort->getCenterPoint(), targetSort->getCenterPoint());
+}
+
+QPainterPath GAction::getBoundPath (void) {
+    if (laidOut)
+        return boundPath;
+    updateContactPoints();
+    return createBoundPath();
+}
+
+QPen GAction::getBoundPen (void) {
+    return boundPen;
+}
+
 ActionPtr GAction::getAction() {
     return action;
 }
 
+GSort* GAction::getSourceSort() {
+    return sourceSort;
+}
+
+GSort* GAction::getTargetSort() {
+    return targetSort;
+}
+
+GSort* GAction::getResultSort() {
+    return resultSort;
+}
+
+bool GAction::hasVisibleSorts() {
+    return sourceSort->isVisible() && targetSort->isVisible() && resultSort->isVisible();
+}
+
 GProcessPtr GAction::getSource() {
     return action->getSource()->getGProcess();
 }
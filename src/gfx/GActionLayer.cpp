@@ -0,0 +1,67 @@
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include "GAction.h"
+#include "GActionLayer.h"
+#include "LevelOfDetail.h"
+
+const int GActionLayer::threshold = 5000;
+
+GActionLayer::GActionLayer() {
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    setAcceptedMouseButtons(Qt::NoButton);
+}
+
+QRectF GActionLayer::boundsOf(GAction* a) {
+    qreal width = std::max(a->getHitPen().widthF(), a->getBoundPen().widthF()) + 1;
+    QLineF straight = a->getStraightHit();
+    QRectF r = QRectF(straight.p1(), straight.p2()).normalized();
+    // an action that is not laid out is drawn as its straight hit only
+    if (a->isLaidOut())
+        r |= a->getHitPath().boundingRect() | a->getBoundPath().boundingRect();
+    return r.adjusted(-width, -width, width, width);
+}
+
+void GActionLayer::addAction(GAction* a) {
+    QRectF b = boundsOf(a);
+    a->setLayer(this, actions.size());
+    actions.push_back(a);
+    bounds.push_back(b);
+    prepareGeometryChange();
+    area |= b;
+}
+
+void GActionLayer::actionChanged(int index) {
+    QRectF before = bounds[index];
+    QRectF after = boundsOf(actions[index]);
+    bounds[index] = after;
+    if (!area.contains(after)) {
+        prepareGeometryChange();
+        area |= after;
+    }
+    update(before | after);
+}
+
+QRectF GActionLayer::boundingRect() const {
+    return area;
+}
+
+void GActionLayer::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    const QRectF exposed = option->exposedRect;
+    const bool straight = LevelOfDetail::of(option, painter) < LevelOfDetail::action;
+    painter->setBrush(Qt::NoBrush);
+    for (int i = 0; i < actions.size(); i++) {
+        GAction* a = actions[i];
+        if (!bounds[i].intersects(exposed) || !a->isVisible()) continue;
+        // zoomed out, only the hits are drawn, as straight lines
+        if (straight || !a->isLaidOut()) {
+            painter->setPen(a->getHitPen());
+            painter->drawLine(a->getStraightHit());
+            continue;
+        }
+        painter->setPen(a->getHitPen());
+        painter->drawPath(a->getHitPath());
+        painter->setPen(a->getBoundPen());
+        painter->drawPath(a->getBoundPath());
+    }
+}
@@ -0,0 +1,70 @@
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include "GLabelItem.h"
+#include "LevelOfDetail.h"
+
+const qreal GLabelItem::margin = 4;
+
+GLabelItem::GLabelItem(const QString& text, const QFont& font, QGraphicsItem* parent) : QGraphicsItem(parent), staticText(text), textFont(font), color(Qt::black) {
+    staticText.setTextFormat(Qt::PlainText);
+    measure();
+}
+
+const QFontMetricsF& GLabelItem::metrics(const QFont& f) {
+    static QHash<QString, QFontMetricsF> shared;
+    const QString key = f.key();
+    QHash<QString, QFontMetricsF>::const_iterator i = shared.constFind(key);
+    if (i == shared.constEnd())
+        i = shared.insert(key, QFontMetricsF(f));
+    return *i;
+}
+
+void GLabelItem::measure() {
+    const QFontMetricsF& fm = metrics(textFont);
+    textSize = QSizeF(fm.width(staticText.text()), fm.height());
+}
+
+QString GLabelItem::toPlainText() const {
+    return staticText.text();
+}
+
+QFont GLabelItem::font() const {
+    return textFont;
+}
+
+void GLabelItem::setFont(const QFont& f) {
+    prepareGeometryChange();
+    // the static text is laid out again when painted with another font
+    textFont = f;
+    measure();
+}
+
+QColor GLabelItem::defaultTextColor() const {
+    return color;
+}
+
+void GLabelItem::setDefaultTextColor(const QColor& c) {
+    color = c;
+    update();
+}
+
+QSizeF GLabelItem::size() const {
+    return textSize + QSizeF(2*margin, 2*margin);
+}
+
+QSizeF GLabelItem::sizeOf(const QString& text, const QFont& font) {
+    const QFontMetricsF& fm = metrics(font);
+    return QSizeF(fm.width(text) + 2*margin, fm.height() + 2*margin);
+}
+
+QRectF GLabelItem::boundingRect() const {
+    return QRectF(QPointF(0, 0), size());
+}
+
+void GLabelItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    if (LevelOfDetail::of(option, painter) < LevelOfDetail::text)
+        return;
+    painter->setFont(textFont);
+    painter->setPen(color);
+    painter->drawStaticText(QPointF(margin, margin), staticText);
+}
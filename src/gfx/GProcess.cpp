@@ -3,9 +3,9 @@
 #include <QColor>
 #include <QBrush>
 #include <QSizeF>
-#include <QTextDocument>
 #include <Qt>
 #include "GProcess.h"
+#include "LevelOfDetail.h"
 #include <math.h>
 
 
@@ -13,26 +13,22 @@ const int GProcess::marginZone  = 10;
 const int GProcess::sortName    = 11;
 const int GProcess::sizeDefault = 100;
 
-GProcess::GProcess(ProcessPtr p,double centerX, double centerY) : process(p) {
-
-    display = new QGraphicsItemGroup();
+GProcess::GProcess(ProcessPtr p,double centerX, double centerY) : process(p), display(0), ellipse(0), text(0), marginRect(0) {
 
     initGeometricsValues(QPointF(centerX,centerY), sizeDefault);
 
-    initEllipseItem();
-
-    initMarginRectItem();
-
-    initTextItem();
+    pen = QPen(QColor(0,0,0));
+    brush = QBrush(QColor(255,255,255));
+    bold=false;
+    actifState=false;
+    numberProcessColor=0;
 }
 
 
 GProcess::~GProcess() {
-    delete text;
-    delete ellipse;
+    deleteItems();
     delete center;
     delete size;
-    delete display;
 }
 
 // Init methods
@@ -42,21 +38,47 @@ void GProcess::initGeometricsValues(QPointF centerPoint, double diameter) {
     size = new QSizeF(diameter,diameter);
 }
 
-void GProcess::initEllipseItem() {
-    ellipse = new QGraphicsEllipseItem (center->x()-sizeDefault/2, center->y()-sizeDefault/2,
+void GProcess::createItems(QGraphicsItem* parent) {
+    if (display) return;
+    // the items are in the coordinates of the sort, which may have moved since it was made
+    QPointF localCenter = parent->mapFromScene(*center);
+
+    display = new QGraphicsItemGroup(parent);
+
+    initEllipseItem(localCenter);
+
+    initMarginRectItem(localCenter);
+
+    initTextItem(localCenter);
+}
+
+void GProcess::deleteItems() {
+    delete text;
+    delete ellipse;
+    delete display;
+    text = 0;
+    ellipse = 0;
+    marginRect = 0;
+    display = 0;
+}
+
+bool GProcess::hasItems() {
+    return display != 0;
+}
+
+void GProcess::initEllipseItem(QPointF localCenter) {
+    ellipse = new LodItem<QGraphicsEllipseItem> (LevelOfDetail::process, localCenter.x()-sizeDefault/2, localCenter.y()-sizeDefault/2,
                                         size->width(), size->height(), display);
-    ellipse->setPen(QPen(QColor(0,0,0)));
-    ellipse->setBrush(QBrush(QColor(255,255,255)));
-    bold=false;
-    numberProcessColor=0;
+    ellipse->setPen(pen);
+    ellipse->setBrush(brush);
 }
 
-void GProcess::initMarginRectItem() {
+void GProcess::initMarginRectItem(QPointF localCenter) {
     int margin(GSort::marginDefault);
 
     marginRect = new QGraphicsRectItem(
-        center->x() - margin/2,
-        center->y() - margin/2,
+        localCenter.x() - margin/2,
+        localCenter.y() - margin/2,
         2*margin,
         2*margin,
         display);
@@ -67,15 +89,13 @@ void GProcess::initMarginRectItem() {
     marginRect->setData(sortName, process->getSort()->getName().c_str());
 }
 
-void GProcess::initTextItem() {
-    text = new QGraphicsTextItem (QString("%1").arg(process->getNumber()), ellipse);
-    text->setFont(QFont("TypeWriter",25));
-    text->setDefaultTextColor(QColor(7,54,66));
-    text->setPos(center->x(), center->y());
+void GProcess::initTextItem(QPointF localCenter) {
+    text = new GLabelItem (QString("%1").arg(process->getNumber()), getLabelFont(), ellipse);
+    text->setDefaultTextColor(getLabelColor());
+    text->setPos(localCenter.x(), localCenter.y());
 
-    QSizeF textSize = text->document()->size();
+    QSizeF textSize = text->size();
     text->setPos(text->x() - textSize.width()/2, text->y() - textSize.height()/2);
-    actifState=false;
 }
 
 //Colorer le process
@@ -88,7 +108,7 @@ void GProcess::colorProcess(QColor color) {
             pen.setWidth(4);
         else
             pen.setWidth(2);
-        ellipse->setBrush(QBrush(QColor(color)));
+        setEllipseBrush(QBrush(QColor(color)));
     }
 }
 
@@ -100,7 +120,7 @@ void GProcess::colorProcessBorder(QColor color) {
         QPen pen;
         pen.setWidth(5);
         pen.setBrush(QBrush(QColor(color)));
-        ellipse->setPen(pen);
+        setEllipsePen(pen);
     }
 }
 
@@ -115,12 +135,12 @@ void GProcess::toBold() {
     if(this->isBold()) {
         pen.setWidth(1);
         pen.setBrush(Qt::black);
-        ellipse->setPen(pen);
+        setEllipsePen(pen);
         bold=false;
     } else {
         pen.setWidth(4);
         pen.setBrush(Qt::black);
-        ellipse->setPen(pen);
+        setEllipsePen(pen);
         bold=true;
     }
 }
@@ -128,13 +148,13 @@ void GProcess::toBold() {
 //make the process in grey color
 void GProcess::beActifProcess(int r, int g, int b) {
     this->setProcessActifState(true);
-    ellipse->setBrush(QBrush(QColor(r,g,b)));
+    setEllipseBrush(QBrush(QColor(r,g,b)));
 }
 
 //make the process in normal color
 void GProcess::beNonActifProcess() {
     this->setProcessActifState(false);
-    ellipse->setBrush(QBrush(QColor(255,255,255)));
+    setEllipseBrush(QBrush(QColor(255,255,255)));
 }
 
 //change the process state actif ou not actif
@@ -169,6 +189,18 @@ QGraphicsRectItem* GProcess::getMarginRect() {
     return this->marginRect;
 }
 
+QPen GProcess::getEllipsePen() {
+    return pen;
+}
+
+QBrush GProcess::getEllipseBrush() {
+    return brush;
+}
+
+QRectF GProcess::getSceneRect() {
+    return QRectF(center->x() - size->width()/2, center->y() - size->height()/2, size->width(), size->height());
+}
+
 QPointF* GProcess::getCenterPoint() {
     return this->center;
 }
@@ -177,10 +209,18 @@ QSizeF* GProcess::getSizeEllipse() {
     return this->size;
 }
 
-QGraphicsTextItem* GProcess::getText() {
+GLabelItem* GProcess::getText() {
     return this->text;
 }
 
+QFont GProcess::getLabelFont() {
+    return QFont("TypeWriter",25);
+}
+
+QColor GProcess::getLabelColor() {
+    return QColor(7,54,66);
+}
+
 bool GProcess::getProcessActifState() {
     return this->actifState;
 }
@@ -191,6 +231,18 @@ int GProcess::getProcessColorNumber() {
 
 // Setters
 
+void GProcess::setEllipsePen(const QPen& p) {
+    pen = p;
+    if (ellipse)
+        ellipse->setPen(p);
+}
+
+void GProcess::setEllipseBrush(const QBrush& b) {
+    brush = b;
+    if (ellipse)
+        ellipse->setBrush(b);
+}
+
 void GProcess::setCoordsForImport(int x, int y) {
     center->setX(x);
     center->setY(y);
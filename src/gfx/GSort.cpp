@@ -2,7 +2,6 @@
 #include <QPen>
 #include <QColor>
 #include <QBrush>
-#include <QTextDocument>
 #include <QCursor>
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsSceneContextMenuEvent>
@@ -14,12 +13,13 @@
 #include <cmath>
 #include <QtGui>
 #include "GSort.h"
+#include "LevelOfDetail.h"
 
 
 const int GSort::marginDefault = 10;
 const int GSort::defaultDistance = 25;
 
-GSort::GSort(SortPtr s, GVNode n, qreal width, qreal height, PHScene* sc) : QGraphicsRectItem(n.centerPos.x()-width/2, n.centerPos.y()-height/2, width, height),sort(s), node(n),scene(sc) {
+GSort::GSort(SortPtr s, GVNode n, qreal width, qreal height, PHScene* sc) : FlatRectItem(QRectF(n.centerPos.x()-width/2, n.centerPos.y()-height/2, width, height)), text(0), sort(s), node(n),scene(sc) {
 
     initInnerAttributes();
 
@@ -27,21 +27,22 @@ GSort::GSort(SortPtr s, GVNode n, qreal width, qreal height, PHScene* sc) : QGra
 
     initRectItem();
 
-    initTextItem();
-
     setCursor(QCursor(Qt::OpenHandCursor));
     setAcceptedMouseButtons(Qt::LeftButton | Qt::RightButton);
 
     initGProcessChildren();
 
+    // a culled scene makes the child items of the sorts around its viewport only
+    if (!scene->isCulled())
+        createItems();
 }
 
 GSort::~GSort() {
+    // the GProcess may outlive the GSort, referenced by their Process: their items go with the GSort
+    deleteItems();
     gProcesses.clear();
-    delete _rect;
     delete leftTopCorner;
     delete sizeRect;
-    delete text;
 }
 
 void GSort::initInnerAttributes() {
@@ -57,19 +58,15 @@ void GSort::initGeometricAttributes(QSize size) {
 }
 
 void GSort::initRectItem() {
-    _rect = new QGraphicsRectItem(QRectF(*leftTopCorner, *sizeRect),this);
-    _rect->setPen(QPen(QColor(0,0,0)));
-    _rect->setBrush(QBrush(QColor(255,255,255)));
+    setPen(QPen(QColor(0,0,0)));
+    setBrush(QBrush(QColor(255,255,255)));
     bold=false;
 }
 
 void GSort::initTextItem() {
-    text = new QGraphicsTextItem (QString(), this);
-    text->setHtml(QString::fromStdString("<u><b><h1> " + sort->getName() + "</h1></b></u>"));
-    text->setDefaultTextColor(*color);
-    text->setPos(leftTopCorner->x()+sizeRect->width()/2, leftTopCorner->y());
-    QSizeF textSize = text->document()->size();
-    text->setPos(text->x() - textSize.width()/2, text->y() - textSize.height());
+    text = new GLabelItem (QString::fromStdString(sort->getName()), getLabelFont(), this);
+    text->setDefaultTextColor(getLabelColor());
+    text->setPos(mapFromScene(getLabelRect().topLeft()));
 }
 
 void GSort::initGProcessChildren() {
@@ -82,19 +79,38 @@ void GSort::initGProcessChildren() {
     }
 
     for(GProcessPtr &gp: gProcesses) {
-        gp->getDisplayItem()->setParentItem(this);
         ProcessPtr* p = gp->getProcess();
         (*p)->setGProcess(gp);
     }
 }
 
+void GSort::createItems() {
+    if (text) return;
+    initTextItem();
+    for(GProcessPtr &gp: gProcesses) {
+        gp->createItems(this);
+    }
+}
+
+void GSort::deleteItems() {
+    for(GProcessPtr &gp: gProcesses) {
+        gp->deleteItems();
+    }
+    delete text;
+    text = 0;
+}
+
+bool GSort::hasItems() {
+    return text != 0;
+}
+
 // mouse press event handler: start "drag"
 void GSort::mousePressEvent(QGraphicsSceneMouseEvent *event) {
 
     QPen pen;
     pen.setWidth(5);
     pen.setBrush(Qt::yellow);
-    _rect->setPen(pen);
+    setPen(pen);
 
     bool test=true;
     // change orientation on right click
@@ -166,7 +182,7 @@ void GSort::mousePressEvent(QGraphicsSceneMouseEvent *event) {
                 QPen pen;
                 pen.setWidth(1);
                 pen.setBrush(Qt::black);
-                _rect->setPen(pen);
+                setPen(pen);
             }
         }
     } else if (event->button() == Qt::LeftButton) {
@@ -186,7 +202,7 @@ void GSort::mouseMoveEvent(QGraphicsSceneMouseEvent *event) {
     QPen pen;
     pen.setWidth(5);
     pen.setBrush(Qt::yellow);
-    _rect->setPen(pen);
+    setPen(pen);
     QPointF eventScenePos(event->scenePos());
 
     if (isRightButtonPressed) {
@@ -214,8 +230,20 @@ void GSort::mouseReleaseEvent(QGraphicsSceneMouseEvent *event) {
 
     setCursor(QCursor(Qt::OpenHandCursor));
 
+    QRectF initRect = getSceneRect().translated(QPointF(initPosPoint) - pos());
     if(isOverAnotherGSort()) {
-        cancelShift();
+        // the sort snaps to the free spot the nearest to where it was dropped, or goes back if there is none close
+        QRectF spot = scene->getSortIndex().freeSpot(getSceneRect(), this);
+        if (spot.isNull())
+            cancelShift();
+        else
+            shiftPosition(spot.topLeft() - getSceneRect().topLeft());
+    }
+
+    // hits routed around the sort where it was, or going through it where it is now, are routed again
+    if (event->button() == Qt::LeftButton && initRect != getSceneRect()) {
+        scene->invalidateArea(initRect);
+        scene->invalidateArea(getSceneRect());
     }
 
     event->accept();
@@ -225,7 +253,7 @@ void GSort::mouseReleaseEvent(QGraphicsSceneMouseEvent *event) {
     else
         pen.setWidth(1);
     pen.setBrush(Qt::black);
-    _rect->setPen(pen);
+    setPen(pen);
 }
 
 void GSort::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event) {
@@ -239,7 +267,7 @@ vector <GProcessPtr> GSort:: getGProcesses() {
 }
 
 QGraphicsRectItem* GSort::getRect() {
-    return this->_rect;
+    return this;
 }
 
 SortPtr GSort::getSort() {
@@ -250,10 +278,28 @@ GVNode GSort::getNode() {
     return this->node;
 }
 
-QGraphicsTextItem* GSort::getText() {
+GLabelItem* GSort::getText() {
     return this->text;
 }
 
+QFont GSort::getLabelFont() {
+    // the name is a title: underlined, bold, twice as large as the default font
+    QFont font;
+    font.setPixelSize(2 * QFontInfo(font).pixelSize());
+    font.setBold(true);
+    font.setUnderline(true);
+    return font;
+}
+
+QColor GSort::getLabelColor() {
+    return *color;
+}
+
+QRectF GSort::getLabelRect() {
+    QSizeF textSize = GLabelItem::sizeOf(QString::fromStdString(sort->getName()), getLabelFont());
+    return QRectF(QPointF(leftTopCorner->x() + (sizeRect->width() - textSize.width())/2, leftTopCorner->y() - textSize.height()), textSize);
+}
+
 QPoint GSort::geteventPressPoint() {
     return this->eventPressPoint;
 }
@@ -266,6 +312,10 @@ QPointF GSort::getCenterPoint() {
     return QPoint(leftTopCorner->x()+sizeRect->width()/2.0,leftTopCorner->y()+sizeRect->height()/2.0);
 }
 
+QRectF GSort::getSceneRect() {
+    return QRectF(*leftTopCorner, QSizeF(*sizeRect));
+}
+
 QSize* GSort::getSizeRect() {
     return this->sizeRect;
 }
@@ -285,15 +335,20 @@ void GSort::changeDisplayState() {
 
     if(simpleDisplay) {
         simpleDisplay = false;
-        _rect->setBrush(QBrush(QColor(255,255,255)));
+        setBrush(QBrush(QColor(255,255,255)));
     } else {
         simpleDisplay = true;
-        _rect->setBrush(QBrush(QColor(255,190,190)));
+        setBrush(QBrush(QColor(255,190,190)));
     }
-    scene->updateActions();
+    scene->invalidateSort(this);
 }
 
 void GSort::shiftPosition(QPointF shiftVector) {
+    shiftGeometry(shiftVector);
+    scene->invalidateSort(this);
+}
+
+void GSort::shiftGeometry(QPointF shiftVector) {
 
     for(GProcessPtr &p: gProcesses) {
         qreal prevPosX = p->getCenterPoint()->x();
@@ -306,45 +361,33 @@ void GSort::shiftPosition(QPointF shiftVector) {
     leftTopCorner->setY(leftTopCorner->y() + shiftVector.y());
 
     setPos(x() + shiftVector.x(), y() + shiftVector.y() );
-
-    scene->updateActions();
+    scene->getSortIndex().update(this);
 }
 
-void GSort::cancelShift() {
-    shiftPosition(initPosPoint - pos());
+void GSort::moveTo(QPointF leftTopCornerPoint) {
+    shiftGeometry(leftTopCornerPoint - *leftTopCorner);
 }
 
-bool GSort::isOverAnotherGSort() {
-    map<string, GSortPtr> listGSorts =scene->getGSorts();
-    bool resetPosition = false;
-
-    for(auto &s : listGSorts) {
-        if(s.second.get()->getSort()->getName()!=sort->getName()) {
-            if(isOver(s.second.get())) {
-                resetPosition = true;
-            }
-        }
+void GSort::setVertical(bool isVertical) {
+    if(vertical != isVertical) {
+        changeOrientationRect();
+        changeOrientationGProcess();
     }
-
-    return resetPosition;
 }
 
-bool GSort::isOver(GSort* otherGSort) {
-    QPointF centerSortMoving(getCenterPoint());
-    QPointF centerSortAround(otherGSort->getCenterPoint());
-    qreal distanceWidthMin = getSizeRect()->width()/2 + otherGSort->getSizeRect()->width()/2 +defaultDistance;
-    qreal distanceHeightMin = getSizeRect()->height()/2 + otherGSort->getSizeRect()->height()/2 +defaultDistance;
-
-    bool xCond = abs(centerSortMoving.x()-centerSortAround.x())<distanceWidthMin;
-    bool yCond = abs(centerSortMoving.y()-centerSortAround.y())<distanceHeightMin;
+void GSort::cancelShift() {
+    shiftPosition(initPosPoint - pos());
+}
 
-    return xCond && yCond;
+bool GSort::isOverAnotherGSort() {
+    return !scene->getSortIndex().isFree(getSceneRect(), this);
 }
 
 void GSort::changeOrientation() {
     changeOrientationRect();
     changeOrientationGProcess();
-    scene->updateActions();
+    scene->invalidateSort(this);
+    scene->invalidateArea(getSceneRect());
 }
 
 void GSort::changeColor() {
@@ -365,7 +408,7 @@ void GSort::changeOrientationRect() {
     qreal topLeftY=0;
     qreal bottomRightX=0;
     qreal bottomRightY=0;
-    _rect->rect().getCoords(&topLeftX,&topLeftY,&bottomRightX,&bottomRightY);
+    rect().getCoords(&topLeftX,&topLeftY,&bottomRightX,&bottomRightY);
 
     //Swap Height and Width
 
@@ -378,15 +421,16 @@ void GSort::changeOrientationRect() {
 
     QPoint sceneLeftTopCorner(topLeftX + (oldSize.width() - sizeRect->width())/2.0, topLeftY + (oldSize.height() - sizeRect->height())/2.0);
 
-    _rect->setRect(QRectF(sceneLeftTopCorner, *sizeRect));
-    setRect(_rect->rect());
-
-    _rect->rect().getCoords(&topLeftX,&topLeftY,&bottomRightX,&bottomRightY);
+    setRect(QRectF(sceneLeftTopCorner, *sizeRect));
+    scene->getSortIndex().update(this);
 
+    rect().getCoords(&topLeftX,&topLeftY,&bottomRightX,&bottomRightY);
 
-    text->setPos(topLeftX+sizeRect->width()/2, topLeftY);
-    QSizeF textSize = text->document()->size();
-    text->setPos(text->x() - textSize.width()/2, text->y() - textSize.height());
+    if (text) {
+        text->setPos(topLeftX+sizeRect->width()/2, topLeftY);
+        QSizeF textSize = text->size();
+        text->setPos(text->x() - textSize.width()/2, text->y() - textSize.height());
+    }
 
 }
 
@@ -395,7 +439,7 @@ void GSort::changeOrientationGProcess() {
     qreal topLeftY=0;
     qreal bottomRightX=0;
     qreal bottomRightY=0;
-    _rect->rect().getCoords(&topLeftX,&topLeftY,&bottomRightX,&bottomRightY);
+    rect().getCoords(&topLeftX,&topLeftY,&bottomRightX,&bottomRightY);
 
     if(vertical) {
         vertical = false;
@@ -411,11 +455,13 @@ void GSort::changeOrientationGProcess() {
             currCenterX = topLeftX +  currPosXProcess;
             currCenterY = topLeftY + GProcess::sizeDefault/2 + marginDefault;
 
-            p->getMarginRect()->setPos(currCenterX -p->getSizeEllipse()->width()/2,currCenterY-p->getSizeEllipse()->height()/2);
+            if (p->hasItems()) {
+                p->getMarginRect()->setPos(currCenterX -p->getSizeEllipse()->width()/2,currCenterY-p->getSizeEllipse()->height()/2);
 
-            p->getEllipseItem()->setRect(currCenterX -p->getSizeEllipse()->width()/2,currCenterY -p->getSizeEllipse()->height()/2, p->getSizeEllipse()->width(), p->getSizeEllipse()->height());
-            QSizeF textSize = p->getText()->document()->size();
-            p->getText()->setPos(currCenterX - textSize.width()/2,currCenterY- textSize.height()/2);
+                p->getEllipseItem()->setRect(currCenterX -p->getSizeEllipse()->width()/2,currCenterY -p->getSizeEllipse()->height()/2, p->getSizeEllipse()->width(), p->getSizeEllipse()->height());
+                QSizeF textSize = p->getText()->size();
+                p->getText()->setPos(currCenterX - textSize.width()/2,currCenterY- textSize.height()/2);
+            }
 
             currPosXProcess+= 2*marginDefault + GProcess::sizeDefault;
         }
@@ -433,10 +479,12 @@ void GSort::changeOrientationGProcess() {
             currCenterX = topLeftX + GProcess::sizeDefault/2 + marginDefault;
             currCenterY = topLeftY +  currPosYProcess;
 
-            p->getMarginRect()->setPos(currCenterX -p->getSizeEllipse()->width()/2,currCenterY-p->getSizeEllipse()->height()/2);
-            p->getEllipseItem()->setRect(currCenterX -p->getSizeEllipse()->width()/2,currCenterY -p->getSizeEllipse()->height()/2, p->getSizeEllipse()->width(), p->getSizeEllipse()->height());
-            QSizeF textSize = p->getText()->document()->size();
-            p->getText()->setPos(currCenterX - textSize.width()/2,currCenterY- textSize.height()/2);
+            if (p->hasItems()) {
+                p->getMarginRect()->setPos(currCenterX -p->getSizeEllipse()->width()/2,currCenterY-p->getSizeEllipse()->height()/2);
+                p->getEllipseItem()->setRect(currCenterX -p->getSizeEllipse()->width()/2,currCenterY -p->getSizeEllipse()->height()/2, p->getSizeEllipse()->width(), p->getSizeEllipse()->height());
+                QSizeF textSize = p->getText()->size();
+                p->getText()->setPos(currCenterX - textSize.width()/2,currCenterY- textSize.height()/2);
+            }
             currPosYProcess+= 2*marginDefault + GProcess::sizeDefault;
         }
     }
@@ -445,27 +493,23 @@ void GSort::changeOrientationGProcess() {
 void GSort::actionsHide() {
 
     this->hide();
-    std::string n = this->getSort()->getName();
-    std::vector<GActionPtr> allActions=scene->getActions();
-
-    for (GActionPtr &a: allActions) {
-        if (a->getAction()->getSource()->getSort()->getName() == n || a->getAction()->getTarget()->getSort()->getName() == n || a->getAction()->getResult()->getSort()->getName() == n) {
-            a->getDisplayItem()->hide();
-        }
+    for (GAction* a : scene->getIncidentActions(this)) {
+        a->setVisible(false);
     }
+    // the hits routed around the sort may now go through it
+    scene->invalidateArea(getSceneRect());
 }
 
 void GSort::actionsShow() {
 
     this->show();
-    std::string n = this->getSort()->getName();
-    // std::vector<GActionPtr> allActions = dynamic_cast<PHScene*>(scene())->getActions();
-    std::vector<GActionPtr> allActions =scene->getActions();
-    for (GActionPtr &a: allActions) {
-        if (!(a->getAction()->getSource()->getSort()->getName() == n || a->getAction()->getTarget()->getSort()->getName() == n || a->getAction()->getResult()->getSort()->getName() == n)) {
-            a->getDisplayItem()->show();
+    // an action is shown again once all of its sorts are
+    for (GAction* a : scene->getIncidentActions(this)) {
+        if (a->hasVisibleSorts()) {
+            a->setVisible(true);
         }
     }
+    scene->invalidateArea(getSceneRect());
 }
 
 void GSort::hide() {
@@ -478,12 +522,12 @@ void GSort::toBold() {
     if(this->isBold()) {
         pen.setWidth(1);
         pen.setBrush(Qt::black);
-        _rect->setPen(pen);
+        setPen(pen);
         bold=false;
     } else {
         pen.setWidth(5);
         pen.setBrush(Qt::black);
-        _rect->setPen(pen);
+        setPen(pen);
         bold=true;
     }
 }
@@ -506,10 +550,8 @@ bool GSort::isBold() {
 
 void GSort::ActionsInToBold() {
 
-    std::vector<GActionPtr> allActions = scene->getActions();
-    for (GActionPtr &a: allActions) {
-        if ( a->getAction()->getTarget()->getSort()->getName() == this->getSort()->getName() || a->getAction()->getResult()->getSort()->getName() == this->getSort()->getName()) {
-            //  if (a->getAction()->getSource()->getSort()->getName() == this->getSort()->getName()){
+    for (GAction* a : scene->getIncidentActions(this)) {
+        if (a->getTargetSort() == this || a->getResultSort() == this) {
             a->toBold();
         }
     }
@@ -520,12 +562,11 @@ void GSort::ActionsInChangeColor() {
 
     // open a color dialog and get the color chosen
     QColor actionsColor = QColorDialog::getColor();
-    std::vector<GActionPtr> allActions =scene->getActions();
     if (!actionsColor.isValid()) {
         return ;
     } else {
-        for (GActionPtr &a: allActions) {
-            if ( a->getAction()->getTarget()->getSort()->getName() == this->getSort()->getName() || a->getAction()->getResult()->getSort()->getName() == this->getSort()->getName()) {
+        for (GAction* a : scene->getIncidentActions(this)) {
+            if (a->getTargetSort() == this || a->getResultSort() == this) {
                 a->colorAction(actionsColor);
             }
         }
@@ -534,9 +575,8 @@ void GSort::ActionsInChangeColor() {
 
 void GSort::ActionsOutToBold() {
 
-    std::vector<GActionPtr> allActions = scene->getActions();
-    for (GActionPtr &a: allActions) {
-        if (a->getAction()->getSource()->getSort()->getName() == this->getSort()->getName()) {
+    for (GAction* a : scene->getIncidentActions(this)) {
+        if (a->getSourceSort() == this) {
             a->toBold();
         }
     }
@@ -547,12 +587,11 @@ void GSort::ActionsOutChangeColor() {
 
     // open a color dialog and get the color chosen
     QColor actionsColor = QColorDialog::getColor();
-    std::vector<GActionPtr> allActions =scene->getActions();
     if (!actionsColor.isValid()) {
         return ;
     } else {
-        for (GActionPtr &a: allActions) {
-            if (a->getAction()->getSource()->getSort()->getName() == this->getSort()->getName()) {
+        for (GAction* a : scene->getIncidentActions(this)) {
+            if (a->getSourceSort() == this) {
                 a->colorAction(actionsColor);
             }
         }
@@ -0,0 +1,20 @@
+#include "LevelOfDetail.h"
+
+const qreal LevelOfDetail::text = 0.4;
+const qreal LevelOfDetail::process = 0.15;
+const qreal LevelOfDetail::action = 0.3;
+
+qreal LevelOfDetail::of(const QStyleOptionGraphicsItem* option, const QPainter* painter) {
+    return option->levelOfDetailFromTransform(painter->worldTransform());
+}
+
+void FlatRectItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    if (LevelOfDetail::of(option, painter) < LevelOfDetail::process) {
+        // a cosmetic outline, so that white sorts stay visible on the background
+        painter->setPen(QPen(pen().color(), 0));
+        painter->setBrush(brush());
+        painter->drawRect(rect());
+        return;
+    }
+    QGraphicsRectItem::paint(painter, option, widget);
+}
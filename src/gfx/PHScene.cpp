@@ -7,6 +7,7 @@
 #include "Exceptions.h"
 #include "PH.h"
 #include "PHScene.h"
+#include "GActionLayer.h"
 #include <map>
 #include <QDebug>
 #include <QApplication>
@@ -14,36 +15,71 @@
 #include <QtGui>
 #include <QGraphicsSceneContextMenuEvent>
 
-PHScene::PHScene(PH* _ph) : ph(_ph) {
+const int PHScene::updateInterval = 16;
+const int PHScene::cullingThreshold = 1000;
+const qreal PHScene::viewportMargin = 500;
+
+PHScene::PHScene(PH* _ph) : ph(_ph), actionLayer(0), culled(false), batchDepth(0), fullUpdatePending(false) {
     // set background color
     setBackgroundBrush(QBrush(QColor(255, 255, 255)));
+
+    updateTimer.setSingleShot(true);
+    updateTimer.setInterval(updateInterval);
+    QObject::connect(&updateTimer, &QTimer::timeout, [this]() {
+        flushActions();
+    });
 }
 
 
 void PHScene::drawFromSkeleton(void) {
-    GVSkeletonGraphPtr gSkeleton = ph->createSkeletonGraph();
-
-    QList<GVNode> gSkeletonNodes = gSkeleton->nodes();
-    for(GVNode &gn : gSkeletonNodes) {
-        for(SortPtr &s : ph->getSorts()) {
-            int nbProcess = (s->getProcesses()).size();
-            int width = GProcess::sizeDefault+2*GSort::marginDefault;
-            int height = nbProcess*(GProcess::sizeDefault+2*GSort::marginDefault);
-            if(gn.name == makeSkeletonNodeName(s->getName())) {
-                sorts.insert(GSortEntry(s->getName(), make_shared<GSort>(s,gn,width,height,this)));
-            }
-        }
+    drawFromLayout(ph->layoutSkeleton());
+}
+
+
+void PHScene::drawFromLayout(const QList<GVNode>& gSkeletonNodes) {
+    // each node carries the index of its sort: one pass, with no name built nor compared
+    vector<SortPtr> skeletonSorts = ph->skeletonSorts();
+    // very large models only make the items of the sorts around the viewport, see setViewport
+    culled = (int) skeletonSorts.size() >= cullingThreshold;
+    for(const GVNode &gn : gSkeletonNodes) {
+        if (gn.index < 0 || gn.index >= (int) skeletonSorts.size()) continue;
+        SortPtr &s = skeletonSorts[gn.index];
+        int nbProcess = (s->getProcesses()).size();
+        int width = GProcess::sizeDefault+2*GSort::marginDefault;
+        int height = nbProcess*(GProcess::sizeDefault+2*GSort::marginDefault);
+        sorts.insert(GSortEntry(s->getName(), make_shared<GSort>(s,gn,width,height,this)));
     }
     // Clear the scene and add sorts item (containing also processes) to the scene
     clear();
+    sortIndex.clear();
+    shownSorts.clear();
+    QRectF modelRect;
     for (auto &s : sorts) {
-        addItem(s.second.get());
+        if (!culled)
+            addItem(s.second.get());
+        sortIndex.insert(s.second.get());
+        modelRect |= s.second->getSceneRect();
     }
 
     createActions();
 
-    for (auto &a : actions) {
-        addItem(a->getDisplayItem());
+    // large scenes draw their actions with a single item
+    if (culled || (int) actions.size() >= GActionLayer::threshold) {
+        actionLayer = new GActionLayer();
+        for (auto &a : actions)
+            actionLayer->addAction(a.get());
+        addItem(actionLayer);
+    } else {
+        for (auto &a : actions) {
+            a->createItems();
+            addItem(a->getDisplayItem());
+        }
+    }
+
+    if (culled) {
+        // the scene no longer grows with its items: it covers the whole model for the scroll bars
+        setSceneRect(modelRect | actionLayer->boundingRect());
+        setViewport(viewport);
     }
 }
 
@@ -69,24 +105,161 @@ std::vector<GActionPtr> PHScene::getActions() {
     return actions;
 }
 
+SortIndex& PHScene::getSortIndex() {
+    return sortIndex;
+}
+
+bool PHScene::isCulled() const {
+    return culled;
+}
+
+void PHScene::setViewport(const QRectF& visible) {
+    viewport = visible;
+    if (!culled) return;
+
+    const QRectF area = visible.adjusted(-viewportMargin, -viewportMargin, viewportMargin, viewportMargin);
+    QSet<GSort*> wanted;
+    for (GSort* s : sortIndex.inRect(area))
+        wanted.insert(s);
+
+    // the sorts taken out of the scene lose their items, made again from the GSort when they come back;
+    // the dragged sort stays
+    QGraphicsItem* grabbed = mouseGrabberItem();
+    for (QSet<GSort*>::iterator i = shownSorts.begin(); i != shownSorts.end(); ) {
+        if (wanted.contains(*i) || (grabbed && (*i == grabbed || (*i)->isAncestorOf(grabbed)))) {
+            ++i;
+            continue;
+        }
+        removeItem(*i);
+        (*i)->deleteItems();
+        i = shownSorts.erase(i);
+    }
+    for (GSort* s : wanted) {
+        if (shownSorts.contains(s)) continue;
+        s->createItems();
+        addItem(s);
+        shownSorts.insert(s);
+    }
+
+    // the actions between sorts reaching the area have their paths, the others are only drawn as straight hits
+    for (auto &a : actions) {
+        if ((a->getSourceSort()->getSceneRect() | a->getTargetSort()->getSceneRect()).intersects(area))
+            a->layOut();
+        else
+            a->release();
+    }
+}
+
+const QRectF& PHScene::getViewport() const {
+    return viewport;
+}
+
+QRectF PHScene::getModelRect() {
+    return culled ? sceneRect() : itemsBoundingRect();
+}
+
 void PHScene::updateActions() {
+    if (batchDepth > 0) {
+        fullUpdatePending = true;
+        return;
+    }
     for(auto &a: actions) {
         a->update();
+        a->setDirty(false);
+    }
+    dirtyActions.clear();
+    updateTimer.stop();
+}
+
+const QVector<GAction*>& PHScene::getIncidentActions(const GSort* s) {
+    static const QVector<GAction*> none;
+    QHash<const GSort*, QVector<GAction*> >::const_iterator i = incidentActions.constFind(s);
+    return i == incidentActions.constEnd() ? none : *i;
+}
+
+void PHScene::invalidateSort(const GSort* s) {
+    for (GAction* a : getIncidentActions(s)) {
+        if (a->isDirty()) continue;
+        a->setDirty(true);
+        dirtyActions.push_back(a);
+    }
+    if (batchDepth == 0 && !dirtyActions.isEmpty() && !updateTimer.isActive())
+        updateTimer.start();
+}
+
+void PHScene::invalidateArea(const QRectF& area) {
+    // the actions are looked at once for all the areas of a batch
+    if (batchDepth > 0) {
+        pendingArea |= area;
+        return;
+    }
+    for (auto &a : actions) {
+        if (a->isDirty() || !a->isLaidOut() || !a->getHitPath().boundingRect().intersects(area)) continue;
+        a->setDirty(true);
+        dirtyActions.push_back(a.get());
+    }
+    if (batchDepth == 0 && !dirtyActions.isEmpty() && !updateTimer.isActive())
+        updateTimer.start();
+}
+
+void PHScene::flushActions() {
+    updateTimer.stop();
+    for (GAction* a : dirtyActions) {
+        a->update();
+        a->setDirty(false);
+    }
+    dirtyActions.clear();
+}
+
+void PHScene::beginBatch() {
+    batchDepth++;
+    updateTimer.stop();
+}
+
+void PHScene::endBatch() {
+    if (--batchDepth > 0) return;
+    if (!pendingArea.isNull()) {
+        invalidateArea(pendingArea);
+        pendingArea = QRectF();
+    }
+    if (fullUpdatePending) {
+        fullUpdatePending = false;
+        updateActions();
+    } else {
+        flushActions();
     }
 }
 
+PHScene::BatchUpdate::BatchUpdate(PHScene* sc) : scene(sc) {
+    scene->beginBatch();
+}
+
+PHScene::BatchUpdate::~BatchUpdate() {
+    scene->endBatch();
+}
+
 void PHScene::createActions() {
-    // create GAction items
+    // create GAction items, and list them in each of their sorts
     for (ActionPtr &a : ph->getActions()) {
         actions.push_back(make_shared<GAction>(a,this));
+        GAction* action = actions.back().get();
+        const GSort* source = action->getSourceSort();
+        const GSort* target = action->getTargetSort();
+        const GSort* result = action->getResultSort();
+        incidentActions[source].push_back(action);
+        if (target != source)
+            incidentActions[target].push_back(action);
+        if (result != source && result != target)
+            incidentActions[result].push_back(action);
     }
 }
 
 void PHScene::setSimpleDisplay(bool onOff) {
+    // only the actions of the sorts that changed are updated, once, at the end of the batch
+    BatchUpdate batch(this);
     for(auto &s : sorts) {
         s.second->setSimpleDisplay(onOff);
     }
-    updateActions();
 }
 
 // context menu event handler
@@ -0,0 +1,134 @@
+#include <QtCore/qmath.h>
+#include <limits>
+#include "GSort.h"
+#include "SortIndex.h"
+
+const qreal SortIndex::cellSize = 200;
+const qreal SortIndex::padding = GSort::defaultDistance;
+const int SortIndex::maxRings = 8;
+
+quint64 SortIndex::key(int i, int j) {
+    return ((quint64) (quint32) i << 32) | (quint32) j;
+}
+
+void SortIndex::addToCells(GSort* s, const QRectF& r) {
+    for (int i = qFloor(r.left()/cellSize); i <= qFloor(r.right()/cellSize); i++)
+        for (int j = qFloor(r.top()/cellSize); j <= qFloor(r.bottom()/cellSize); j++)
+            cells[key(i, j)].push_back(s);
+}
+
+void SortIndex::removeFromCells(GSort* s, const QRectF& r) {
+    for (int i = qFloor(r.left()/cellSize); i <= qFloor(r.right()/cellSize); i++)
+        for (int j = qFloor(r.top()/cellSize); j <= qFloor(r.bottom()/cellSize); j++) {
+            QHash<quint64, QVector<GSort*> >::iterator c = cells.find(key(i, j));
+            if (c == cells.end()) continue;
+            c->removeOne(s);
+            if (c->isEmpty())
+                cells.erase(c);
+        }
+}
+
+void SortIndex::insert(GSort* s) {
+    QRectF r = s->getSceneRect().adjusted(-padding, -padding, padding, padding);
+    rects.insert(s, r);
+    addToCells(s, r);
+}
+
+void SortIndex::remove(GSort* s) {
+    QHash<GSort*, QRectF>::iterator r = rects.find(s);
+    if (r == rects.end()) return;
+    removeFromCells(s, *r);
+    rects.erase(r);
+}
+
+void SortIndex::update(GSort* s) {
+    QHash<GSort*, QRectF>::iterator r = rects.find(s);
+    if (r == rects.end()) return;
+    QRectF moved = s->getSceneRect().adjusted(-padding, -padding, padding, padding);
+    // a small move usually keeps the sort in the same cells
+    if (qFloor(moved.left()/cellSize) != qFloor(r->left()/cellSize) || qFloor(moved.right()/cellSize) != qFloor(r->right()/cellSize)
+            || qFloor(moved.top()/cellSize) != qFloor(r->top()/cellSize) || qFloor(moved.bottom()/cellSize) != qFloor(r->bottom()/cellSize)) {
+        removeFromCells(s, *r);
+        addToCells(s, moved);
+    }
+    *r = moved;
+}
+
+void SortIndex::clear() {
+    cells.clear();
+    rects.clear();
+}
+
+QRectF SortIndex::rect(GSort* s) const {
+    return rects.value(s);
+}
+
+QVector<GSort*> SortIndex::inRect(const QRectF& area) const {
+    QVector<GSort*> found;
+    for (int i = qFloor(area.left()/cellSize); i <= qFloor(area.right()/cellSize); i++)
+        for (int j = qFloor(area.top()/cellSize); j <= qFloor(area.bottom()/cellSize); j++) {
+            QHash<quint64, QVector<GSort*> >::const_iterator c = cells.find(key(i, j));
+            if (c == cells.end()) continue;
+            for (GSort* s : *c)
+                if (!found.contains(s) && rects.value(s).intersects(area))
+                    found.push_back(s);
+        }
+    return found;
+}
+
+bool SortIndex::isFree(const QRectF& r, const GSort* except) const {
+    for (int i = qFloor(r.left()/cellSize); i <= qFloor(r.right()/cellSize); i++)
+        for (int j = qFloor(r.top()/cellSize); j <= qFloor(r.bottom()/cellSize); j++) {
+            QHash<quint64, QVector<GSort*> >::const_iterator c = cells.find(key(i, j));
+            if (c == cells.end()) continue;
+            for (GSort* s : *c)
+                if (s != except && rects.value(s).intersects(r))
+                    return false;
+        }
+    return true;
+}
+
+QRectF SortIndex::freeSpot(const QRectF& r, const GSort* except, int rings) const {
+    for (int ring = 0; ring <= rings; ring++)
+        for (int i = -ring; i <= ring; i++)
+            for (int j = -ring; j <= ring; j++) {
+                if (qAbs(i) != ring && qAbs(j) != ring) continue;
+                QRectF moved = r.translated(i*padding, j*padding);
+                if (isFree(moved, except))
+                    return moved;
+            }
+    return QRectF();
+}
+
+// cells crossed by the segment, walked one after the other (Amanatides and Woo)
+QVector<GSort*> SortIndex::alongLine(const QLineF& line) const {
+    QVector<GSort*> found;
+    const qreal infinity = std::numeric_limits<qreal>::infinity();
+    const qreal dx = line.dx(), dy = line.dy();
+
+    int i = qFloor(line.x1()/cellSize), j = qFloor(line.y1()/cellSize);
+    const int iEnd = qFloor(line.x2()/cellSize), jEnd = qFloor(line.y2()/cellSize);
+    const int stepI = dx > 0 ? 1 : -1, stepJ = dy > 0 ? 1 : -1;
+    qreal tMaxI = dx != 0 ? ((i + (dx > 0 ? 1 : 0))*cellSize - line.x1())/dx : infinity;
+    qreal tMaxJ = dy != 0 ? ((j + (dy > 0 ? 1 : 0))*cellSize - line.y1())/dy : infinity;
+    const qreal tDeltaI = dx != 0 ? cellSize/qAbs(dx) : infinity;
+    const qreal tDeltaJ = dy != 0 ? cellSize/qAbs(dy) : infinity;
+
+    forever {
+        QHash<quint64, QVector<GSort*> >::const_iterator c = cells.find(key(i, j));
+        if (c != cells.end())
+            for (GSort* s : *c)
+                if (!found.contains(s))
+                    found.push_back(s);
+        if ((i == iEnd && j == jEnd) || (tMaxI > 1 && tMaxJ > 1))
+            break;
+        if (tMaxI < tMaxJ) {
+            tMaxI += tDeltaI;
+            i += stepI;
+        } else {
+            tMaxJ += tDeltaJ;
+            j += stepJ;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QHash>
+#include <QRectF>
+#include <QThread>
+#include <QtConcurrent>
+#include "ForceLayout.h"
+
+const int ForceLayout::iterations = 300;
+const qreal ForceLayout::theta = 1.0;
+const int ForceLayout::overlapPasses = 20;
+const qreal ForceLayout::spreadFactor = 1.05;
+
+
+// Barnes-Hut quadtree of the positions of the nodes, rebuilt at each iteration
+
+class ForceLayout::QuadTree {
+
+  public:
+
+    QuadTree(const std::vector<QPointF>& points) {
+        QRectF bounds;
+        for (const QPointF& p : points)
+            bounds |= QRectF(p, QSizeF(1, 1));
+        Cell root;
+        root.center = bounds.center();
+        root.half = std::max(bounds.width(), bounds.height()) / 2 + 1;
+        cells.reserve(2 * points.size() + 1);
+        cells.push_back(root);
+        for (int i = 0; i < (int) points.size(); i++)
+            insert(points, i);
+    }
+
+    // repulsive force on the node i at p, from all the other nodes: k²/d for each of them
+    QPointF repulsion(const QPointF& p, int i, qreal k2) const {
+        QPointF force;
+        int stack[4 * maxDepth + 4];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Cell& c = cells[stack[--top]];
+            if (c.count == 0 || c.point == i) continue;
+
+            QPointF d = p - c.mass / c.count;
+            qreal dist2 = d.x()*d.x() + d.y()*d.y();
+            bool leaf = c.children[0] < 0;
+            if (leaf || 4*c.half*c.half < theta*theta*dist2) {
+                // nodes at the same place are pushed apart in a direction depending on their index
+                if (dist2 < 1e-6) {
+                    d = QPointF(std::cos(i), std::sin(i));
+                    dist2 = 1;
+                }
+                force += d * (c.count * k2 / dist2);
+            } else {
+                for (int q = 0; q < 4; q++)
+                    stack[top++] = c.children[q];
+            }
+        }
+        return force;
+    }
+
+  private:
+
+    // beyond this depth, nodes (at almost the same place) are kept together in a leaf
+    static const int maxDepth = 48;
+
+    struct Cell {
+        QPointF center;
+        qreal half;
+        QPointF mass;       // sum of the positions of the nodes in the cell
+        int count = 0;
+        int point = -1;     // the node of a leaf holding a single node
+        int children[4] = {-1, -1, -1, -1};
+    };
+
+    int quadrant(const Cell& c, const QPointF& p) const {
+        return (p.x() >= c.center.x() ? 1 : 0) + (p.y() >= c.center.y() ? 2 : 0);
+    }
+
+    void split(int c) {
+        for (int q = 0; q < 4; q++) {
+            Cell child;
+            child.half = cells[c].half / 2;
+            child.center = cells[c].center + QPointF(q & 1 ? child.half : -child.half, q & 2 ? child.half : -child.half);
+            cells[c].children[q] = cells.size();
+            cells.push_back(child);
+        }
+    }
+
+    void insert(const std::vector<QPointF>& points, int i) {
+        const QPointF& p = points[i];
+        int c = 0;
+        for (int depth = 0; ; depth++) {
+            cells[c].mass += p;
+            cells[c].count++;
+            if (cells[c].count == 1) {
+                cells[c].point = i;
+                return;
+            }
+            if (cells[c].children[0] < 0) {
+                if (depth >= maxDepth) {
+                    cells[c].point = -1;
+                    return;
+                }
+                // the node of the leaf goes down to a child
+                int other = cells[c].point;
+                cells[c].point = -1;
+                split(c);
+                Cell& child = cells[cells[c].children[quadrant(cells[c], points[other])]];
+                child.mass = points[other];
+                child.count = 1;
+                child.point = other;
+            }
+            c = cells[c].children[quadrant(cells[c], p)];
+        }
+    }
+
+    std::vector<Cell> cells;
+};
+
+
+// Layout
+
+ForceLayout::ForceLayout(const LayoutGraph& g, qreal s) : graph(g), sep(s), tree(0) {
+    const int n = graph.sizes.size();
+    offsets.assign(n + 1, 0);
+    for (auto &e : graph.edges) {
+        offsets[e.first + 1]++;
+        offsets[e.second + 1]++;
+    }
+    for (int i = 0; i < n; i++)
+        offsets[i + 1] += offsets[i];
+    adjacency.resize(offsets[n]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (auto &e : graph.edges) {
+        adjacency[fill[e.first]++] = e.second;
+        adjacency[fill[e.second]++] = e.first;
+    }
+}
+
+void ForceLayout::computeForces(int begin, int end) {
+    const qreal k2 = k*k;
+    for (int i = begin; i < end; i++) {
+        QPointF force = tree->repulsion(positions[i], i, k2);
+        // attractive force d²/k along each edge
+        for (int a = offsets[i]; a < offsets[i + 1]; a++) {
+            QPointF d = positions[adjacency[a]] - positions[i];
+            force += d * (std::sqrt(d.x()*d.x() + d.y()*d.y()) / k);
+        }
+        displacements[i] = force;
+    }
+}
+
+bool ForceLayout::removeOverlaps() {
+    const int n = positions.size();
+    const qreal cell = *std::max_element(graph.sizes.begin(), graph.sizes.end()) + sep;
+    auto key = [cell](const QPointF& p, int di, int dj) {
+        return ((quint64) (quint32) ((int) std::floor(p.x() / cell) + di) << 32) | (quint32) ((int) std::floor(p.y() / cell) + dj);
+    };
+
+    QHash<quint64, std::vector<int> > grid;
+    grid.reserve(n);
+    for (int i = 0; i < n; i++)
+        grid[key(positions[i], 0, 0)].push_back(i);
+
+    bool moved = false;
+    for (int i = 0; i < n; i++) {
+        const QPointF cellOfI = positions[i];
+        for (int di = -1; di <= 1; di++)
+            for (int dj = -1; dj <= 1; dj++) {
+                QHash<quint64, std::vector<int> >::const_iterator c = grid.find(key(cellOfI, di, dj));
+                if (c == grid.end()) continue;
+                for (int j : *c) {
+                    if (j <= i) continue;
+                    const qreal required = (graph.sizes[i] + graph.sizes[j]) / 2 + sep;
+                    QPointF d = positions[j] - positions[i];
+                    qreal overlapX = required - std::abs(d.x());
+                    qreal overlapY = required - std::abs(d.y());
+                    if (overlapX <= 0 || overlapY <= 0) continue;
+
+                    // push both nodes apart along the axis where they overlap the least
+                    QPointF push = overlapX < overlapY
+                                   ? QPointF((d.x() < 0 || (d.x() == 0 && i > j) ? -overlapX : overlapX) / 2, 0)
+                                   : QPointF(0, (d.y() < 0 || (d.y() == 0 && i > j) ? -overlapY : overlapY) / 2);
+                    positions[i] -= push;
+                    positions[j] += push;
+                    moved = true;
+                }
+            }
+    }
+    return moved;
+}
+
+std::vector<QPointF> ForceLayout::run() {
+    const int n = graph.sizes.size();
+    positions.assign(n, QPointF());
+    if (n == 0)
+        return positions;
+
+    qreal meanSize = 0;
+    for (qreal s : graph.sizes)
+        meanSize += s;
+    meanSize /= n;
+    k = meanSize + sep;
+
+    // nodes start on a sunflower spiral, so that the layout is the same from one run to another
+    for (int i = 0; i < n; i++) {
+        qreal r = k * std::sqrt((qreal) i);
+        positions[i] = QPointF(r * std::cos(2.39996 * i), r * std::sin(2.39996 * i));
+    }
+    displacements.assign(n, QPointF());
+
+    // work shared between the threads by ranges of nodes
+    const int threads = std::max(1, QThread::idealThreadCount());
+    const int chunk = std::max(64, n / (4 * threads) + 1);
+    std::vector<std::pair<int, int> > ranges;
+    for (int begin = 0; begin < n; begin += chunk)
+        ranges.push_back(std::make_pair(begin, std::min(n, begin + chunk)));
+
+    // the largest move allowed to a node decreases geometrically from about the size of the layout to k/100
+    qreal temperature = k * std::sqrt((qreal) n);
+    const qreal cooling = std::pow(0.01 * k / temperature, 1.0 / iterations);
+
+    for (int it = 0; it < iterations; it++) {
+        QuadTree quadTree(positions);
+        tree = &quadTree;
+        QtConcurrent::blockingMap(ranges, [this](const std::pair<int, int>& r) {
+            computeForces(r.first, r.second);
+        });
+        tree = 0;
+
+        for (int i = 0; i < n; i++) {
+            const QPointF& d = displacements[i];
+            qreal length = std::sqrt(d.x()*d.x() + d.y()*d.y());
+            if (length > temperature)
+                positions[i] += d * (temperature / length);
+            else
+                positions[i] += d;
+        }
+        temperature *= cooling;
+    }
+
+    // overlaps left in the dense parts are removed by spreading the whole layout a little before pushing again
+    for (int round = 0; round < 100; round++) {
+        bool moved = true;
+        for (int pass = 0; pass < overlapPasses && moved; pass++)
+            moved = removeOverlaps();
+        if (!moved) break;
+        for (QPointF& p : positions)
+            p *= spreadFactor;
+    }
+
+    // top-left corner of the layout at (0,0)
+    qreal left = std::numeric_limits<qreal>::max();
+    qreal top = std::numeric_limits<qreal>::max();
+    for (int i = 0; i < n; i++) {
+        left = std::min(left, positions[i].x() - graph.sizes[i] / 2);
+        top = std::min(top, positions[i].y() - graph.sizes[i] / 2);
+    }
+    for (QPointF& p : positions)
+        p -= QPointF(left, top);
+    return positions;
+}
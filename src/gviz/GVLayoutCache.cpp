@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <QCache>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include "GVLayoutCache.h"
+
+const int GVLayoutCache::memoryNodes = 500000;
+const quint32 GVLayoutCache::version = 3;
+
+namespace {
+
+const quint32 cacheMagic = 0x4750484c; // "GPHL"
+
+// the least bytes a node takes in a file: name length, index, center and size
+const qint64 nodeMinSize = 4 + 4 + 8 + 4 + 4;
+
+// layouts of the session, the cost of a layout being its number of nodes
+QCache<QByteArray, QList<GVNode> > memory(GVLayoutCache::memoryNodes);
+QMutex memoryMutex;
+
+}
+
+QString GVLayoutCache::path(const QByteArray& key) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (dir.isEmpty())
+        return QString();
+    return dir + "/gph/layouts/" + QString::fromLatin1(key.toHex()) + ".gvl";
+}
+
+bool GVLayoutCache::find(const QByteArray& key, QList<GVNode>& nodes) {
+
+    {
+        QMutexLocker locker(&memoryMutex);
+        if (QList<GVNode>* found = memory.object(key)) {
+            nodes = *found;
+            return true;
+        }
+    }
+
+    QString file = path(key);
+    if (file.isEmpty())
+        return false;
+    QFile input(file);
+    if (!input.open(QIODevice::ReadOnly))
+        return false;
+
+    // a file that cannot be read is ignored, the skeleton is laid out again and the file replaced
+    QDataStream in(&input);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, fileVersion, count;
+    in >> magic >> fileVersion >> count;
+    if (in.status() != QDataStream::Ok || magic != cacheMagic || fileVersion != version)
+        return false;
+    // the count comes from the file, it cannot announce more nodes than the file holds
+    if (count > input.size() / nodeMinSize)
+        return false;
+
+    QList<GVNode> read;
+    read.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        GVNode node;
+        qint32 index;
+        in >> node.name >> index >> node.centerPos >> node.width >> node.height;
+        node.index = index;
+        read << node;
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    nodes = read;
+    QMutexLocker locker(&memoryMutex);
+    memory.insert(key, new QList<GVNode>(read), std::max(1, read.size()));
+    return true;
+}
+
+void GVLayoutCache::insert(const QByteArray& key, const QList<GVNode>& nodes) {
+
+    {
+        QMutexLocker locker(&memoryMutex);
+        memory.insert(key, new QList<GVNode>(nodes), std::max(1, nodes.size()));
+    }
+
+    QString file = path(key);
+    if (file.isEmpty() || !QDir().mkpath(QFileInfo(file).absolutePath()))
+        return;
+
+    // the file is written aside and renamed, so that concurrent sessions never read half a file
+    QSaveFile output(file);
+    if (!output.open(QIODevice::WriteOnly))
+        return;
+    QDataStream out(&output);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << cacheMagic << version << (quint32) nodes.size();
+    for (const GVNode& node : nodes)
+        out << node.name << (qint32) node.index << node.centerPos << node.width << node.height;
+    if (out.status() == QDataStream::Ok)
+        output.commit();
+}
@@ -0,0 +1,69 @@
+#define HAVE_STRING_H
+#include <graphviz/gvc.h>
+#include "GVLayoutService.h"
+
+
+// Lock
+
+GVLayoutService::Lock::Lock() : locker(&GVLayoutService::mutex()) {
+#ifdef _WIN32
+    perThread = _configthreadlocale(_ENABLE_PER_THREAD_LOCALE);
+    previous = setlocale(LC_NUMERIC, NULL);
+    setlocale(LC_NUMERIC, "C");
+#else
+    static const locale_t cNumeric = newlocale(LC_NUMERIC_MASK, "C", (locale_t) 0);
+    previous = uselocale(cNumeric);
+#endif
+}
+
+GVLayoutService::Lock::~Lock() {
+#ifdef _WIN32
+    setlocale(LC_NUMERIC, previous.c_str());
+    _configthreadlocale(perThread);
+#else
+    uselocale(previous);
+#endif
+}
+
+QMutex& GVLayoutService::mutex() {
+    static QMutex m(QMutex::Recursive);
+    return m;
+}
+
+
+// Service
+
+GVLayoutService::GVLayoutService() {
+    Lock lock;
+    _context = gvContext();
+}
+
+GVLayoutService::~GVLayoutService() {
+    Lock lock;
+    gvFreeContext(_context);
+}
+
+GVLayoutService& GVLayoutService::instance() {
+    static GVLayoutService service;
+    return service;
+}
+
+GVC_t* GVLayoutService::context() {
+    return _context;
+}
+
+bool GVLayoutService::layout(Agraph_t* graph, const QString& alg) {
+    Lock lock;
+    gvFreeLayout(_context, graph);
+    return gvLayout(_context, graph, const_cast<char *>(qPrintable(alg))) == 0;
+}
+
+void GVLayoutService::freeLayout(Agraph_t* graph) {
+    Lock lock;
+    gvFreeLayout(_context, graph);
+}
+
+void GVLayoutService::render(Agraph_t* graph, const QString& format, const QString& path) {
+    Lock lock;
+    gvRenderFilename(_context, graph, const_cast<char *>(qPrintable(format)), const_cast<char *>(qPrintable(path)));
+}
@@ -5,103 +5,85 @@
 #include <QStringList>
 #include <QRectF>
 #include "Exceptions.h"
+#include "GVLayoutService.h"
 #include "GVSkeletonGraph.h"
-#include "locale.h"
 
 const qreal GVSkeletonGraph::DotDefaultDPI=72.0;
 const qreal GVSkeletonGraph::nodeSize = 1;
 const qreal GVSkeletonGraph::sepValue = 30.0;
+const qreal GVSkeletonGraph::layoutDPI = 96.0;
 
 // Utils
 
 static inline Agnode_t* _agnode(Agraph_t* object, QString name) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8"); // To set "." as decimal delimiter for GraphViz
-
     return agnode(object, const_cast<char *>(qPrintable(name)), 1);
 }
 
 static inline Agraph_t* _agopen(QString name, Agdesc_t kind) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
     return agopen(const_cast<char *>(qPrintable(name)),kind, 0);
 }
 
 static inline QString _agget(void *object, QString attr, QString alt=QString()) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
     QString str = agget(object, const_cast<char *>(qPrintable(attr)));
     if(str==QString()) return alt;
     else return str;
 }
 
-static inline void _gvLayout(GVC_t* context, Agraph_t* graph, QString alg) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
-    gvLayout(context, graph, const_cast<char *>(qPrintable(alg)));
-}
-
 GVSkeletonGraph::GVSkeletonGraph(QString name, QFont font) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
+    // load the graphviz context, if this is the first graph, before taking the lock
+    GVLayoutService::instance();
 
-    _context = gvContext();
+    GVLayoutService::Lock lock;
     _graph = _agopen(name, Agstrictdirected);
     setGraphAttributes();
     setFont(font);
 }
 
 GVSkeletonGraph::~GVSkeletonGraph() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
-    gvFreeLayout(_context,_graph);
+    GVLayoutService::Lock lock;
+    GVLayoutService::instance().freeLayout(_graph);
     agclose(_graph);
-    gvFreeContext(_context);
 }
 
 void GVSkeletonGraph::setGraphAttributes() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-    setGraphObjectAttributes(_graph,"dpi","96,0");
+    setGraphObjectAttributes(_graph,"dpi",QString::number(layoutDPI));
     QString strSepValue = QString::number(sepValue).prepend("+");
     setGraphObjectAttributes(_graph, "sep", strSepValue);
 }
 
 void GVSkeletonGraph::setGraphObjectAttributes(void *object, QString attr, QString value) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
+    GVLayoutService::Lock lock;
     agsafeset(object, const_cast<char *>(qPrintable(attr)),const_cast<char *>(qPrintable(value)),const_cast<char *>(qPrintable(value)));
 }
 
 void GVSkeletonGraph::setFont(QFont font) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
     _font = font;
     setGraphObjectAttributes(_graph,"fontname",font.family());
 }
 
-void GVSkeletonGraph::applyLayout() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
-    gvFreeLayout(_context, _graph);
-    _gvLayout(_context, _graph, "dot");
+bool GVSkeletonGraph::applyLayout(const QString& alg) {
+    // the force-directed engines remove the overlaps between the nodes, keeping them sep apart
+    if (alg != "dot")
+        setGraphObjectAttributes(_graph, "overlap", "prism");
+    return GVLayoutService::instance().layout(_graph, alg);
 }
 
 
 void GVSkeletonGraph::exportToPng() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
-    gvRenderFilename(_context,_graph,"png","out.png");
+    GVLayoutService::instance().render(_graph, "png", "out.png");
 }
 
 // Node management
 
 QList<GVNode> GVSkeletonGraph::nodes() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
+    GVLayoutService::Lock lock;
     QList<GVNode> list;
     qreal dpi = this->getDPI();
     for(QMap<QString, Agnode_t*>::const_iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
         Agnode_t *node = it.value();
         GVNode object;
         object.name = ND_label(node)->text;
+        object.index = _indices.value(node, -1);
 
         qreal x = ND_coord(node).x *(dpi/GVSkeletonGraph::DotDefaultDPI);
         qreal y = -ND_coord(node).y *(dpi/GVSkeletonGraph::DotDefaultDPI);
@@ -117,50 +99,44 @@ QList<GVNode> GVSkeletonGraph::nodes() {
     return list;
 }
 
-void GVSkeletonGraph::addNode(const QString& name) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
+void GVSkeletonGraph::addNode(const QString& name, int index) {
+    GVLayoutService::Lock lock;
     if(_nodes.contains(name)) removeNode(name);
 
-    _nodes.insert(name, _agnode(_graph, name));
+    Agnode_t* node = _agnode(_graph, name);
+    _nodes.insert(name, node);
+    if (index >= 0)
+        _indices.insert(node, index);
 }
 
 void GVSkeletonGraph::removeNode(const QString& name) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
+    GVLayoutService::Lock lock;
     if(_nodes.contains(name)) {
+        _indices.remove(_nodes[name]);
         agdelete(_graph, _nodes[name]);
         _nodes.remove(name);
     }
 }
 
 bool GVSkeletonGraph::hasNode(const QString& name) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
     if(_nodes.contains(name)) return true;
     return false;
 }
 
 Agnode_t* GVSkeletonGraph::getNode(const QString& name) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
     if(_nodes.contains(name)) return _nodes[name];
 
     return NULL;
 }
 
 void GVSkeletonGraph::setNodeSize(void* object, qreal width, qreal height) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
-    QString nodePtsWidth = QString("%1").arg(width/_agget(_graph,"dpi", "96,0").replace(',',".").toDouble());
-    setGraphObjectAttributes(object,"width",nodePtsWidth.replace('.',","));
-    QString nodePtsHeight = QString("%1").arg(height/_agget(_graph,"dpi", "96,0").replace(',',".").toDouble());
-    setGraphObjectAttributes(object,"height",nodePtsHeight.replace('.',","));
+    // sizes in inches, always written with a '.' by QString::number
+    qreal dpi = getDPI();
+    setGraphObjectAttributes(object,"width",QString::number(width/dpi));
+    setGraphObjectAttributes(object,"height",QString::number(height/dpi));
 }
 
 void GVSkeletonGraph::clearNodes() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
     QList<QString> keys = _nodes.keys();
     for(int i=0; i<keys.size(); ++i) {
         removeNode(keys.at(i));
@@ -170,8 +146,7 @@ void GVSkeletonGraph::clearNodes() {
 // Edge management
 
 void GVSkeletonGraph::addEdge(const QString &source, const QString &target) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
+    GVLayoutService::Lock lock;
     if (hasNode(source) && hasNode(target)) {
         QPair<QString, QString> key(source, target);
 
@@ -183,15 +158,17 @@ void GVSkeletonGraph::addEdge(const QString &source, const QString &target) {
     }
 }
 
-void GVSkeletonGraph::removeEdge(const QString &source, const QString &target) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
+void GVSkeletonGraph::addEdge(Agnode_t* source, Agnode_t* target) {
+    GVLayoutService::Lock lock;
+    agedge(_graph, source, target, 0, 1);
+}
 
+void GVSkeletonGraph::removeEdge(const QString &source, const QString &target) {
     removeEdge(QPair<QString, QString>(source, target));
 }
 
 void GVSkeletonGraph::removeEdge(const QPair<QString, QString>& key) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
+    GVLayoutService::Lock lock;
     if(_edges.contains(key)) {
         agdelete(_graph, _edges[key]);
         _edges.remove(key);
@@ -199,20 +176,17 @@ void GVSkeletonGraph::removeEdge(const QPair<QString, QString>& key) {
 }
 
 bool GVSkeletonGraph::connectionExists(const QString &sourceName, const QString &targetName) {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-
     QPair<QString,QString> firstPossibility(sourceName,targetName);
     QPair<QString,QString> secondPossibility(targetName,sourceName);
     return _edges.contains(firstPossibility)||_edges.contains(secondPossibility);
 }
 
 qreal GVSkeletonGraph::getDPI() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
-    return _agget(_graph, "dpi","96,0").replace(',',".").toDouble();
+    GVLayoutService::Lock lock;
+    return _agget(_graph, "dpi",QString::number(layoutDPI)).toDouble();
 }
 
 Agraph_t* GVSkeletonGraph::graph() {
-    setlocale(LC_NUMERIC,"en_US.UTF-8");
     return this->_graph;
 }
 
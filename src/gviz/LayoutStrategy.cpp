@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include "LayoutStrategy.h"
+
+const int LayoutStrategy::dotMaxNodes = 400;
+const int LayoutStrategy::dotMaxEdges = 2000;
+const int LayoutStrategy::sfdpMaxNodes = 3000;
+const qint64 LayoutStrategy::timeBudget = 5000;
+
+namespace {
+
+const char* const algorithmNames[] = { "auto", "dot", "neato", "sfdp", "fdp", "circo", "force" };
+
+QAtomicInt defaultAlgorithm(LayoutStrategy::Auto);
+
+QMap<LayoutStrategy::Algorithm, LayoutStrategy::Stats> stats;
+QMutex statsMutex;
+
+}
+
+LayoutStrategy::Algorithm LayoutStrategy::getDefault() {
+    return (Algorithm) defaultAlgorithm.load();
+}
+
+void LayoutStrategy::setDefault(Algorithm algorithm) {
+    defaultAlgorithm.store(algorithm);
+}
+
+LayoutStrategy::Algorithm LayoutStrategy::choose(int nodes, int edges) {
+    Algorithm algorithm = getDefault();
+    if (algorithm != Auto)
+        return algorithm;
+
+    if (nodes <= dotMaxNodes && edges <= dotMaxEdges && !tooSlow(Dot, nodes, edges))
+        return Dot;
+    if (nodes <= sfdpMaxNodes && !tooSlow(Sfdp, nodes, edges))
+        return Sfdp;
+    return Force;
+}
+
+bool LayoutStrategy::tooSlow(Algorithm algorithm, int nodes, int edges) {
+    QMutexLocker locker(&statsMutex);
+    QMap<Algorithm, Stats>::const_iterator s = stats.find(algorithm);
+    return s != stats.end() && s->msPerElement * (nodes + edges) > timeBudget;
+}
+
+void LayoutStrategy::record(Algorithm algorithm, int nodes, int edges, qint64 ms) {
+    QMutexLocker locker(&statsMutex);
+    QMap<Algorithm, Stats>::iterator s = stats.find(algorithm);
+    if (s == stats.end())
+        s = stats.insert(algorithm, Stats{0, 0, 0, 0});
+    s->runs++;
+    s->totalMs += ms;
+    s->maxMs = std::max(s->maxMs, ms);
+    // small graphs say little about the speed of an algorithm
+    if (nodes + edges >= 100)
+        s->msPerElement = std::max(s->msPerElement, (double) ms / (nodes + edges));
+}
+
+QMap<LayoutStrategy::Algorithm, LayoutStrategy::Stats> LayoutStrategy::statistics() {
+    QMutexLocker locker(&statsMutex);
+    return stats;
+}
+
+QString LayoutStrategy::name(Algorithm algorithm) {
+    return algorithmNames[algorithm];
+}
+
+LayoutStrategy::Algorithm LayoutStrategy::fromName(const QString& name, bool* ok) {
+    for (int a = Auto; a <= Force; a++) {
+        if (name.compare(algorithmNames[a], Qt::CaseInsensitive) == 0) {
+            if (ok) *ok = true;
+            return (Algorithm) a;
+        }
+    }
+    if (ok) *ok = false;
+    return Auto;
+}
+
+QStringList LayoutStrategy::names() {
+    QStringList list;
+    for (int a = Auto; a <= Force; a++)
+        list << algorithmNames[a];
+    return list;
+}
@@ -1,5 +1,6 @@
 #pragma GCC diagnostic ignored "-Wparentheses"
 #pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,15 +11,24 @@
 #include <QStringList>
 #include <QImage>
 #include <QPainter>
+#include <QPdfWriter>
+#include <QPageSize>
+#include <QFontInfo>
+#include <QFuture>
+#include <QtConcurrent>
+#include <QtCore/qmath.h>
 #include <Qt>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include <QTextStream>
+#include <QHash>
 #include<math.h>
+#include <cstring>
 #include "axe.h"
 #include "Exceptions.h"
 #include "IO.h"
 #include "PHIO.h"
+#include "PNGWriter.h"
 #include "Area.h"
 #include<utility>
 
@@ -26,6 +36,9 @@ using boost::make_shared;
 using std::string;
 using std::vector;
 
+const qreal PHIO::screenDPI = 96.0;
+const int PHIO::pngBandBytes = 64*1024*1024;
+
 
 // process actual parsing, finally
 typedef const char* TabChar;
@@ -206,23 +219,249 @@ void PHIO::writeToFile (string const& path, PHPtr ph) {
 
 
 // save PH as PNG image
-void PHIO::exportToPNG(PHPtr ph, QString name) {
-
-    // create the image and render it
-    // TODO make margins (currently: 4 pixels) configuration variables
-    QImage* image = new QImage(ph->getGraphicsScene()->width()+4, ph->getGraphicsScene()->height()+4, QImage::Format_ARGB32_Premultiplied);
-    QPainter* p = new QPainter();
-    p->begin(image);
-    p->setRenderHint(QPainter::Antialiasing);
-    ph->getGraphicsScene()->render(p);
-    p->end();
+void PHIO::exportToPNG(PHPtr ph, QString name, qreal dpi) {
 
     // add .png to the name if necessary
     if (name.indexOf(QString(".png"), 0, Qt::CaseInsensitive) < 0)
         name += ".png";
 
-    // save it
-    image->save(name, "PNG");
+    // image geometry
+    // TODO make margins (currently: 4 pixels) configuration variables
+    PHScenePtr scene = ph->getGraphicsScene();
+    const QRectF sceneRect = scene->sceneRect();
+    const qreal scale = dpi / screenDPI;
+    const qreal margin = 2;
+    const int width  = qCeil(sceneRect.width()  * scale + 2*margin);
+    const int height = qCeil(sceneRect.height() * scale + 2*margin);
+    // the stride of a row, 4 bytes a pixel, is computed on 64 bits: it overflows an int for very wide images
+    const qint64 rowBytes = 4 * (qint64) width;
+    const int bandHeight = (int) qBound<qint64>(1, pngBandBytes / rowBytes, height);
+
+    PNGWriter writer(name, width, height, dpi);
+
+    // the scene may only be painted from this thread: bands are rendered here, one after the other,
+    // while the previous band is being compressed by a worker thread
+    QFuture<void> encoding;
+    bool encodingFailed = false;
+    const QRectF viewport = scene->getViewport();
+    for (int top = 0; top < height; top += bandHeight) {
+        QImage band(width, std::min(bandHeight, height - top), QImage::Format_ARGB32_Premultiplied);
+        band.fill(Qt::transparent);
+
+        QPainter p(&band);
+        p.setRenderHint(QPainter::Antialiasing);
+        QRectF source(sceneRect.left() - margin/scale, sceneRect.top() + (top - margin)/scale,
+                      band.width()/scale, band.height()/scale);
+        // a culled scene puts in the scene the sorts of each band in turn
+        scene->setViewport(source);
+        scene->render(&p, QRectF(band.rect()), source, Qt::IgnoreAspectRatio);
+        p.end();
+
+        // the flag of the encoder is only read once it is finished
+        encoding.waitForFinished();
+        if (encodingFailed)
+            break;
+        encoding = QtConcurrent::run([&writer, &encodingFailed, band]() {
+            try {
+                writer.writeRows(band);
+            } catch (io_error&) {
+                encodingFailed = true;
+            }
+        });
+    }
+    encoding.waitForFinished();
+    scene->setViewport(viewport);
+
+    if (encodingFailed)
+        throw io_error() << file_info(name.toStdString());
+    writer.finish();
+}
+
+
+namespace {
+
+// the primitives of the scene, in scene coordinates, in the order they are stacked
+// (sorts, then their processes, then the actions on top of them)
+// sorts that are hidden in the GUI are left out, as are the actions hidden with them
+
+QRectF sortRect(GSortPtr gs) {
+    return gs->getRect()->mapRectToScene(gs->getRect()->rect());
+}
+
+// processes and labels are read from their GProcess and GSort, which have no items outside the viewport of a
+// culled scene
+QRectF processRect(GProcessPtr gp) {
+    return gp->getSceneRect();
+}
+
+// a paint attribute (stroke or fill), with its opacity if the color is translucent
+QString svgPaint(const char* attribute, const QColor& c) {
+    QString s = QString("%1=\"%2\"").arg(attribute).arg(c.name());
+    return c.alpha() == 255 ? s : s + QString(" %1-opacity=\"%2\"").arg(attribute).arg(c.alphaF());
+}
+
+// the stroke attributes of a pen, a cosmetic pen being one pixel wide as displayed in the GUI
+QString svgStroke(const QPen& pen) {
+    if (pen.style() == Qt::NoPen)
+        return "stroke=\"none\"";
+    const qreal w = pen.widthF() > 0 ? pen.widthF() : 1;
+    QString s = svgPaint("stroke", pen.color()) + QString(" stroke-width=\"%1\"").arg(w);
+    if (pen.style() == Qt::DashLine)
+        s += QString(" stroke-dasharray=\"%1,%2\"").arg(4*w).arg(2*w);
+    return s;
+}
+
+QString svgFill(const QBrush& brush) {
+    return brush.style() == Qt::NoBrush ? "fill=\"none\"" : svgPaint("fill", brush.color());
+}
+
+QString svgFont(const QFont& f) {
+    QString s = QString("font-family=\"%1\" font-size=\"%2\"").arg(f.family().toHtmlEscaped()).arg(QFontInfo(f).pixelSize());
+    if (f.bold())      s += " font-weight=\"bold\"";
+    if (f.underline()) s += " text-decoration=\"underline\"";
+    return s;
+}
+
+void writeSVGText(QTextStream& t, const QString& text, const QRectF& box, const QFont& font, const QColor& color) {
+    t << "<text x=\"" << box.center().x() << "\" y=\"" << box.center().y()
+      << "\" text-anchor=\"middle\" dominant-baseline=\"central\" " << svgFont(font)
+      << ' ' << svgPaint("fill", color) << '>' << text.toHtmlEscaped() << "</text>\n";
+}
+
+// the path is written element by element: Qt stores arcs as cubic Bézier curves, as SVG does
+void writeSVGPath(QTextStream& t, const QPainterPath& path, const QPen& pen) {
+    t << "<path " << svgStroke(pen) << " fill=\"none\" d=\"";
+    for (int i = 0; i < path.elementCount(); i++) {
+        const QPainterPath::Element& e = path.elementAt(i);
+        switch (e.type) {
+            case QPainterPath::MoveToElement:      t << 'M'; break;
+            case QPainterPath::LineToElement:      t << 'L'; break;
+            case QPainterPath::CurveToElement:     t << 'C'; break;
+            case QPainterPath::CurveToDataElement: t << ' '; break;
+        }
+        t << e.x << ' ' << e.y;
+    }
+    t << "\"/>\n";
+}
+
+}
+
+void PHIO::exportToSVG(PHPtr ph, QString name) {
+
+    // add .svg to the name if necessary
+    if (name.indexOf(QString(".svg"), 0, Qt::CaseInsensitive) < 0)
+        name += ".svg";
+
+    QFile output(name);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        throw io_error() << file_info(name.toStdString());
+
+    PHScenePtr scene = ph->getGraphicsScene();
+    const QRectF box = scene->sceneRect().adjusted(-2, -2, 2, 2);
+
+    // elements are written one after the other through the buffer of the stream, the scene is never copied
+    QTextStream t(&output);
+    t.setCodec("UTF-8");
+    t.setRealNumberNotation(QTextStream::FixedNotation);
+    t.setRealNumberPrecision(2);
+
+    t << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    t << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"" << box.width() << "\" height=\"" << box.height()
+      << "\" viewBox=\"" << box.left() << ' ' << box.top() << ' ' << box.width() << ' ' << box.height() << "\">\n";
+    t << "<rect x=\"" << box.left() << "\" y=\"" << box.top() << "\" width=\"" << box.width() << "\" height=\"" << box.height()
+      << "\" " << svgFill(scene->backgroundBrush()) << "/>\n";
+
+    t << "<g id=\"sorts\">\n";
+    for (auto& s : scene->getGSorts()) {
+        GSortPtr gs = s.second;
+        if (!gs->GSort::isVisible()) continue;
+
+        const QRectF r = sortRect(gs);
+        t << "<rect x=\"" << r.left() << "\" y=\"" << r.top() << "\" width=\"" << r.width() << "\" height=\"" << r.height()
+          << "\" " << svgStroke(gs->getRect()->pen()) << ' ' << svgFill(gs->getRect()->brush()) << "/>\n";
+        writeSVGText(t, QString::fromStdString(gs->getSort()->getName()), gs->getLabelRect(),
+                     gs->getLabelFont(), gs->getLabelColor());
+
+        for (GProcessPtr& gp : gs->getGProcesses()) {
+            const QRectF e = processRect(gp);
+            t << "<ellipse cx=\"" << e.center().x() << "\" cy=\"" << e.center().y() << "\" rx=\"" << e.width()/2 << "\" ry=\"" << e.height()/2
+              << "\" " << svgStroke(gp->getEllipsePen()) << ' ' << svgFill(gp->getEllipseBrush()) << "/>\n";
+            writeSVGText(t, QString::number(gp->getProcessPtr()->getNumber()), e,
+                         gp->getLabelFont(), gp->getLabelColor());
+        }
+    }
+    t << "</g>\n";
+
+    t << "<g id=\"actions\">\n";
+    for (GActionPtr& a : scene->getActions()) {
+        if (!a->isVisible()) continue;
+        writeSVGPath(t, a->getHitPath(), a->getHitPen());
+        writeSVGPath(t, a->getBoundPath(), a->getBoundPen());
+    }
+    t << "</g>\n";
+    t << "</svg>\n";
+
+    t.flush();
+    if (t.status() != QTextStream::Ok)
+        throw io_error() << file_info(name.toStdString());
+}
+
+void PHIO::exportToPDF(PHPtr ph, QString name) {
+
+    // add .pdf to the name if necessary
+    if (name.indexOf(QString(".pdf"), 0, Qt::CaseInsensitive) < 0)
+        name += ".pdf";
+
+    PHScenePtr scene = ph->getGraphicsScene();
+    const QRectF box = scene->sceneRect().adjusted(-2, -2, 2, 2);
+
+    // one page the size of the scene, one device unit per pixel of the scene as displayed in the GUI
+    QPdfWriter writer(name);
+    writer.setResolution(screenDPI);
+    writer.setPageSize(QPageSize(box.size() * 72 / screenDPI, QPageSize::Point));
+    writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+
+    // the primitives are painted directly as PDF vector operators and text, instead of rendering the scene
+    QPainter p;
+    if (!p.begin(&writer))
+        throw io_error() << file_info(name.toStdString());
+    p.setRenderHint(QPainter::Antialiasing);
+    p.translate(-box.topLeft());
+    p.fillRect(box, scene->backgroundBrush());
+
+    for (auto& s : scene->getGSorts()) {
+        GSortPtr gs = s.second;
+        if (!gs->GSort::isVisible()) continue;
+
+        p.setPen(gs->getRect()->pen());
+        p.setBrush(gs->getRect()->brush());
+        p.drawRect(sortRect(gs));
+        p.setPen(gs->getLabelColor());
+        p.setFont(gs->getLabelFont());
+        p.drawText(gs->getLabelRect(), Qt::AlignCenter, QString::fromStdString(gs->getSort()->getName()));
+
+        for (GProcessPtr& gp : gs->getGProcesses()) {
+            const QRectF e = processRect(gp);
+            p.setPen(gp->getEllipsePen());
+            p.setBrush(gp->getEllipseBrush());
+            p.drawEllipse(e);
+            p.setPen(gp->getLabelColor());
+            p.setFont(gp->getLabelFont());
+            p.drawText(e, Qt::AlignCenter, QString::number(gp->getProcessPtr()->getNumber()));
+        }
+    }
+
+    p.setBrush(Qt::NoBrush);
+    for (GActionPtr& a : scene->getActions()) {
+        if (!a->isVisible()) continue;
+        p.setPen(a->getHitPen());
+        p.drawPath(a->getHitPath());
+        p.setPen(a->getBoundPen());
+        p.drawPath(a->getBoundPath());
+    }
+
+    if (!p.end())
+        throw io_error() << file_info(name.toStdString());
 }
 
 
@@ -283,9 +522,9 @@ void PHIO::exportXMLMetadata(MainWindow *window, QFile &output) {
         stream.writeTextElement("color", myarea->getPHPtr()->getGraphicsScene()->getGSort(a->getName())->getRect()->brush().color().name());
 
         stream.writeStartElement("label");
-        stream.writeAttribute("text", myarea->getPHPtr()->getGraphicsScene()->getGSort(a->getName())->getText()->toPlainText());
+        stream.writeAttribute("text", QString::fromStdString(a->getName()));
 
-        stream.writeTextElement("font", myarea->getPHPtr()->getGraphicsScene()->getGSort(a->getName())->getText()->font().toString());
+        stream.writeTextElement("font", myarea->getPHPtr()->getGraphicsScene()->getGSort(a->getName())->getLabelFont().toString());
 
         stream.writeStartElement("pos");
         stream.writeAttribute("x", "");
@@ -355,6 +594,253 @@ void PHIO::exportXMLMetadata(MainWindow *window, QFile &output) {
     stream.writeEndDocument();
 }
 
+// binary layout file: header, sort name table, sort records and groups, all in host byte order
+namespace {
+
+const char    layoutMagic[4]  = {'G', 'P', 'H', 'L'};
+const quint32 layoutByteOrder = 0x01020304;
+const quint16 layoutVersion   = 1;
+
+struct LayoutHeader {
+    char    magic[4];
+    quint32 byteOrder;
+    quint16 version;
+    quint16 flags;
+    quint32 sortCount;
+    quint32 nameBytes;
+    quint32 groupBytes;
+    quint32 background;
+};
+
+struct LayoutSortRecord {
+    float   left;
+    float   top;
+    quint32 color;
+    quint8  vertical;
+    quint8  visible;
+    quint8  bold;
+    quint8  padding;
+};
+
+static_assert(sizeof(LayoutHeader) == 28, "unexpected padding in LayoutHeader");
+static_assert(sizeof(LayoutSortRecord) == 16, "unexpected padding in LayoutSortRecord");
+
+template <typename T> inline void appendRaw(QByteArray &buffer, const T &value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// copy the next sizeof(T) bytes of the buffer into value, or fail if the buffer is truncated
+template <typename T> inline void readRaw(const char* &cursor, const char* end, T &value) {
+    if (end - cursor < (std::ptrdiff_t) sizeof(T))
+        throw wrong_layout_format();
+    memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+}
+
+}
+
+
+// export layout to binary file
+void PHIO::exportBinaryLayout(Area *area, QFile &output) {
+
+    PHScenePtr scene = area->myArea->getPHPtr()->getGraphicsScene();
+    map<string, GSortPtr> gSorts = scene->getGSorts();
+
+    // sort ID table: the ID of a sort is its rank in the table
+    std::vector<quint32> nameOffsets;
+    std::map<QString, quint32> sortIds;
+    QByteArray names;
+    std::vector<LayoutSortRecord> records;
+    nameOffsets.reserve(gSorts.size() + 1);
+    records.reserve(gSorts.size());
+
+    for (auto &s : gSorts) {
+        sortIds[QString::fromStdString(s.first)] = records.size();
+        nameOffsets.push_back(names.size());
+        names.append(s.first.c_str(), s.first.size());
+
+        LayoutSortRecord r;
+        r.left      = s.second->getLeftTopCornerPoint()->x();
+        r.top       = s.second->getLeftTopCornerPoint()->y();
+        r.color     = s.second->getRect()->brush().color().rgba();
+        r.vertical  = s.second->isVertical();
+        r.visible   = s.second->GSort::isVisible();
+        r.bold      = s.second->isBold();
+        r.padding   = 0;
+        records.push_back(r);
+    }
+    nameOffsets.push_back(names.size());
+
+    // groups: name, color, visibility and the IDs of their sorts
+    QByteArray groups;
+    QList<QTreeWidgetItem*> groupsFound = area->treeArea->groupsTree->findItems("", Qt::MatchContains, 0);
+    for (QTreeWidgetItem* &g : groupsFound) {
+        if (g->parent() != NULL) continue;
+        QByteArray groupName = g->text(0).toUtf8();
+        appendRaw(groups, (quint32) groupName.size());
+        groups.append(groupName);
+        appendRaw(groups, (quint32) g->foreground(0).color().rgba());
+        appendRaw(groups, (quint32) !g->font(0).italic());
+
+        std::vector<quint32> members;
+        for (int i(0); i < g->childCount(); i++) {
+            auto id = sortIds.find(g->child(i)->text(0));
+            if (id != sortIds.end())
+                members.push_back(id->second);
+        }
+        appendRaw(groups, (quint32) members.size());
+        groups.append(reinterpret_cast<const char*>(members.data()), members.size() * sizeof(quint32));
+    }
+
+    LayoutHeader header;
+    memcpy(header.magic, layoutMagic, sizeof(layoutMagic));
+    header.byteOrder    = layoutByteOrder;
+    header.version      = layoutVersion;
+    header.flags        = 0;
+    header.sortCount    = records.size();
+    header.nameBytes    = names.size();
+    header.groupBytes   = groups.size();
+    header.background   = scene->backgroundBrush().color().rgba();
+
+    QByteArray buffer;
+    buffer.reserve(sizeof(header) + nameOffsets.size() * sizeof(quint32) + names.size()
+                   + records.size() * sizeof(LayoutSortRecord) + groups.size());
+    appendRaw(buffer, header);
+    buffer.append(reinterpret_cast<const char*>(nameOffsets.data()), nameOffsets.size() * sizeof(quint32));
+    buffer.append(names);
+    buffer.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(LayoutSortRecord));
+    buffer.append(groups);
+
+    if (output.write(buffer) != buffer.size())
+        throw io_error() << file_info(output.fileName().toStdString());
+}
+
+
+// import layout from binary file
+void PHIO::importBinaryLayout(Area *area, QFile &input) {
+
+    const QByteArray data = input.readAll();
+    const char* cursor = data.constData();
+    const char* end = cursor + data.size();
+
+    LayoutHeader header;
+    readRaw(cursor, end, header);
+    if (memcmp(header.magic, layoutMagic, sizeof(layoutMagic)) != 0
+            || header.byteOrder != layoutByteOrder
+            || header.version != layoutVersion)
+        throw wrong_layout_format();
+
+    // locate the sections
+    quint64 expectedSize = sizeof(header) + ((quint64) header.sortCount + 1) * sizeof(quint32) + header.nameBytes
+                           + (quint64) header.sortCount * sizeof(LayoutSortRecord) + header.groupBytes;
+    if (expectedSize != (quint64) data.size())
+        throw wrong_layout_format();
+    const char* offsets = cursor;
+    const char* names   = offsets + (header.sortCount + 1) * sizeof(quint32);
+    const char* records = names + header.nameBytes;
+    const char* groups  = records + header.sortCount * sizeof(LayoutSortRecord);
+
+    PHScenePtr scene = area->myArea->getPHPtr()->getGraphicsScene();
+    scene->setBackgroundBrush(QBrush(QColor::fromRgba(header.background)));
+
+    // sorts
+    std::vector<GSortPtr> sortsById(header.sortCount);
+    for (quint32 i = 0; i < header.sortCount; i++) {
+        quint32 nameRange[2];
+        memcpy(nameRange, offsets + i * sizeof(quint32), sizeof(nameRange));
+        if (nameRange[0] > nameRange[1] || nameRange[1] > header.nameBytes)
+            throw wrong_layout_format();
+        string name(names + nameRange[0], nameRange[1] - nameRange[0]);
+
+        LayoutSortRecord r;
+        memcpy(&r, records + i * sizeof(LayoutSortRecord), sizeof(r));
+
+        GSortPtr gs;
+        try {
+            gs = scene->getGSort(name);
+        } catch (sort_not_found&) {
+            continue;
+        }
+        sortsById[i] = gs;
+
+        gs->setVertical(r.vertical);
+        gs->moveTo(QPointF(r.left, r.top));
+        gs->getRect()->setBrush(QBrush(QColor::fromRgba(r.color)));
+        if ((bool) r.bold != gs->isBold())
+            gs->toBold();
+    }
+    scene->updateActions();
+
+    // hidden sorts, once the actions are in place
+    for (quint32 i = 0; i < header.sortCount; i++) {
+        LayoutSortRecord r;
+        memcpy(&r, records + i * sizeof(LayoutSortRecord), sizeof(r));
+        if (r.visible || !sortsById[i].get()) continue;
+
+        sortsById[i]->actionsHide();
+        QList<QTreeWidgetItem*> sortsInTheSortsTree = area->treeArea->sortsTree->findItems(QString::fromStdString(sortsById[i]->getSort()->getName()), Qt::MatchExactly, 0);
+        for (QTreeWidgetItem* &a : sortsInTheSortsTree) {
+            QFont f = a->font(0);
+            f.setItalic(true);
+            a->setFont(0, f);
+        }
+    }
+
+    // groups
+    area->treeArea->groupsTree->clear();
+    area->treeArea->groups.clear();
+    area->treeArea->groupsPalette->clear();
+    cursor = groups;
+    while (cursor < end) {
+        quint32 nameSize, color, visible, memberCount;
+        readRaw(cursor, end, nameSize);
+        if ((quint32) (end - cursor) < nameSize)
+            throw wrong_layout_format();
+        QString groupName = QString::fromUtf8(cursor, nameSize);
+        cursor += nameSize;
+        readRaw(cursor, end, color);
+        readRaw(cursor, end, visible);
+        readRaw(cursor, end, memberCount);
+
+        QTreeWidgetItem* groupe = new QTreeWidgetItem(area->treeArea->groupsTree);
+        groupe->setText(0, groupName);
+        groupe->setForeground(0, QBrush(QColor::fromRgba(color)));
+        QFont f = groupe->font(0);
+        f.setItalic(!visible);
+        groupe->setFont(0, f);
+        area->treeArea->groups.push_back(groupe);
+        area->treeArea->groupsPalette->insert(groupe, QColor::fromRgba(color));
+
+        for (quint32 m = 0; m < memberCount; m++) {
+            quint32 id;
+            readRaw(cursor, end, id);
+            if (id >= header.sortCount)
+                throw wrong_layout_format();
+            if (!sortsById[id].get()) continue;
+
+            GSortPtr gs = sortsById[id];
+            QTreeWidgetItem* b = new QTreeWidgetItem(groupe);
+            b->setText(0, QString::fromStdString(gs->getSort()->getName()));
+            b->setFont(0, f);
+            gs->getRect()->setPen(QPen(QColor::fromRgba(color), 4));
+        }
+    }
+}
+
+namespace {
+
+// a sort as it is written in the TikZ file
+struct TikzSort {
+    SortPtr sort;
+    GSortPtr gsort;
+    bool visible;
+    QString name;       // name of the process nodes
+    QString tikzName;   // name of the sort node, '_' being replaced by '-'
+    QPointF center;
+};
+
+}
+
 void PHIO::exportTikzMetadata(PHPtr ph, QFile &output) {
 
     QTextStream t(&output);
@@ -390,156 +876,117 @@ void PHIO::exportTikzMetadata(PHPtr ph, QFile &output) {
     t << "\\tikzstyle{style fond 5}=[draw=black,line width=1mm]\n\n";
     t << "\\begin{tikzpicture}\n";
 
+    // resolve every sort once: its graphical counterpart, its names and its position
+    // sorts are indexed by address so that actions find the sort of their processes in constant time
     list<SortPtr> allSorts = ph->getSorts();
-    list <pair <int, int> > txy;
-
-    int pnumS;
-    int pnumT;
-    int pnumB;
-
-    string snameS;
-    string snameT;
+    std::vector<TikzSort> table;
+    table.reserve(allSorts.size());
+    QHash<const Sort*, const TikzSort*> bySort;
+    bySort.reserve(allSorts.size());
+    vector<QPointF> centers;
+    for(SortPtr &s : allSorts) {
+        TikzSort ts;
+        ts.sort = s;
+        ts.gsort = ph->getGraphicsScene()->getGSort(s->getName());
+        ts.visible = ts.gsort->GSort::isVisible();
+        ts.name = QString::fromStdString(s->getName());
+        ts.tikzName = ts.name;
+        ts.tikzName.replace('_', '-');
+        ts.center = ts.gsort->GSort::getCenterPoint();
+        table.push_back(ts);
+        if(ts.visible)
+            centers.push_back(ts.center);
+    }
+    for(const TikzSort &ts : table)
+        bySort.insert(ts.sort.get(), &ts);
 
-    string direction="";
-    string sensAction;
+    const QPointF origin = findOrigin(centers);
 
     QString listState="\\TState{";
-
-    string n;
-    int nb=0;
-    float x;
-    float y;
-
     bool primo=true;
     bool existListSort=true;
 
-    pair<int,int> o;
-    for(SortPtr &s : allSorts) {
-        if(ph->getGraphicsScene()->getGSort(s->getName())->GSort::isVisible()) {
-
-            x=ph->getGraphicsScene()->getGSort(s->getName())->GSort::getCenterPoint().x();
-            y=ph->getGraphicsScene()->getGSort(s->getName())->GSort::getCenterPoint().y();
-            o= std::make_pair(x,y);
-            txy.push_back(o);
-        }
-    }
-
-    pair<int,int> origin=findOrigin(txy);
-    string orientation="l";
-
-    for(SortPtr &s : allSorts) {
-        if(ph->getGraphicsScene()->getGSort(s->getName())->GSort::isVisible()) {
-            n=s->getName();
-            std::replace( n.begin(), n.end(), '_', '-');
-
-            nb=s->countProcesses();
-
-            x=(float)(ph->getGraphicsScene()->getGSort(s->getName())->GSort::getCenterPoint().x()-origin.first)/100;
-            y=(float)(ph->getGraphicsScene()->getGSort(s->getName())->GSort::getCenterPoint().y()-origin.second)/-100;
-
-            if(ph->getGraphicsScene()->getGSort(s->getName())->GSort::isVertical()) {
-                orientation = "l";
-            } else {
-                orientation = "t";
-            }
-            t <<  "   \\TSort{("<< x <<","<< y <<")}{"<< QString::fromStdString(n) <<"}{"<<nb<<"}{"<< QString::fromStdString(orientation) << "}\n";
-
-            for(GProcessPtr &gp: ph->getGraphicsScene()->getGSort(s->getName())->getGProcesses()) {
-                if(gp->getProcessActifState()) {
-                    if(primo) {
-                        listState=listState + QString::fromStdString(s->getName())+ "_" +  QString::number(gp->getProcessPtr()->getNumber());
-                        primo=false;
-                        std::cout << "aaaa  " << listState.toStdString() << std::endl;
-                    } else {
-                        listState=listState + ","+QString::fromStdString(s->getName()) + "_" + QString::number(gp->getProcessPtr()->getNumber());
-                    }
-                    t << "  \\node[process, style fond 2] at ("<< QString::fromStdString(s->getName()) << "_" << gp->getProcessPtr()->getNumber() << ".center) {}; \n" ;
-
-                    if(gp->getProcessColorNumber()!=0) {
-                        t << "  \\node[process, style fond " << gp->getProcessColorNumber() << "] at ("<< QString::fromStdString(s->getName()) << "_" << gp->getProcessPtr()->getNumber() << ".center) {}; \n" ;
-                        existListSort=false;
-                    }
+    for(const TikzSort &ts : table) {
+        if(!ts.visible) continue;
+
+        float x=(ts.center.x()-origin.x())/100;
+        float y=(ts.center.y()-origin.y())/-100;
+        t <<  "   \\TSort{("<< x <<","<< y <<")}{"<< ts.tikzName <<"}{"<< ts.sort->countProcesses() <<"}{"<< (ts.gsort->GSort::isVertical() ? "l" : "t") << "}\n";
+
+        for(GProcessPtr &gp: ts.gsort->getGProcesses()) {
+            if(gp->getProcessActifState()) {
+                int number = gp->getProcessPtr()->getNumber();
+                if(!primo)
+                    listState += ',';
+                listState += ts.name + '_' + QString::number(number);
+                primo=false;
+                t << "  \\node[process, style fond 2] at ("<< ts.name << "_" << number << ".center) {}; \n" ;
+
+                if(gp->getProcessColorNumber()!=0) {
+                    t << "  \\node[process, style fond " << gp->getProcessColorNumber() << "] at ("<< ts.name << "_" << number << ".center) {}; \n" ;
+                    existListSort=false;
                 }
             }
         }
     }
 
     listState = listState + "} \n";
-    //t << QString::fromStdString(listState);
     if(existListSort)
         t << listState;
-    std::vector<GActionPtr> allActions =ph->getGraphicsScene()->getActions();
-
-    int xProcessSource;
-    int yProcessSource;
-    int xProcessTarget;
-    int yProcessTarget;
-    int difY;
-    string actionBoldColor;
-
-    for (GActionPtr &a: allActions) {
-
-        snameS=a->getAction()->getSource()->getSort()->getName();
-        snameT=a->getAction()->getTarget()->getSort()->getName();
-        direction="";
-        actionBoldColor="";
-
-        if(ph->getGraphicsScene()->getGSort(snameS)->isVisible() && ph->getGraphicsScene()->getGSort(snameT)->isVisible()) {
-            pnumS=a->getAction()->getSource()->getNumber();
-            pnumT=a->getAction()->getTarget()->getNumber();
-            pnumB=a->getAction()->getResult()->getNumber();
-
-            xProcessSource=a->getAction()->getSource()->getGProcess()->getCenterPoint()->x();
-            yProcessSource=a->getAction()->getSource()->getGProcess()->getCenterPoint()->y();
-
-            xProcessTarget=a->getAction()->getTarget()->getGProcess()->getCenterPoint()->x();
-            yProcessTarget=a->getAction()->getTarget()->getGProcess()->getCenterPoint()->y();
-
-            difY = yProcessSource - yProcessTarget;
-            int minXY=500;
-
-            if(difY <= minXY ) {
-                if(xProcessSource <= xProcessTarget) {
-                    direction="west";
-                    sensAction="right";
-                } else {
-                    direction="east";
-                    sensAction="left";
-                }
-            } else if( difY >= minXY ) {
-                if(yProcessSource <= yProcessTarget) {
-                    direction = "north";
-                    sensAction="right";
-                } else {
-                    direction = "south";
-                    sensAction="left";
-                }
-            }
-
-            std::replace( snameS.begin(), snameS.end(), '_', '-');
-            std::replace( snameT.begin(), snameT.end(), '_', '-');
-
-            if(a->getActionColorNumber()!=-1) {
 
-                actionBoldColor=",style trait 1" + QString::number( a->getActionColorNumber()).toStdString();
+    const int minXY=500;
+    for (GActionPtr &a: ph->getGraphicsScene()->getActions()) {
+
+        ActionPtr action = a->getAction();
+        const TikzSort* source = bySort.value(action->getSource()->getSort().get());
+        const TikzSort* target = bySort.value(action->getTarget()->getSort().get());
+        if(!source->visible || !target->visible) continue;
+
+        const QString& snameS = source->tikzName;
+        const QString& snameT = target->tikzName;
+        int pnumS=action->getSource()->getNumber();
+        int pnumT=action->getTarget()->getNumber();
+        int pnumB=action->getResult()->getNumber();
+
+        const QPointF* processSource = action->getSource()->getGProcess()->getCenterPoint();
+        const QPointF* processTarget = action->getTarget()->getGProcess()->getCenterPoint();
+        qreal difY = processSource->y() - processTarget->y();
+
+        const char* direction="";
+        const char* sensAction="";
+        if(difY <= minXY ) {
+            if(processSource->x() <= processTarget->x()) {
+                direction="west";
+                sensAction="right";
+            } else {
+                direction="east";
+                sensAction="left";
             }
+        } else {
+            if(processSource->y() <= processTarget->y()) {
+                direction = "north";
+                sensAction="right";
+            } else {
+                direction = "south";
+                sensAction="left";
+            }
+        }
 
+        QString actionBoldColor;
+        if(a->getActionColorNumber()!=-1)
+            actionBoldColor=",style trait 1" + QString::number(a->getActionColorNumber());
 
-            //  actionBoldColor="style trait 12";
-
-            if(snameS.compare(snameT)==0 && pnumS==pnumT) {
-                if (pnumS < pnumB) {
-                    t <<  "  \\THit{"<<QString::fromStdString(snameS)<<"_"<< pnumS  <<"}{out=-40, in=40, selfhit,"<< QString::fromStdString(actionBoldColor)<<"}{"<<QString::fromStdString(snameT) << "_"<< pnumT << "}{}{"<<QString::fromStdString(snameT)<<"_"<<pnumB<<"} \n";
-                    t <<  " \\path[bounce, bend right] \\TBounce{" << QString::fromStdString(snameS) << "_" << pnumS << "}{"<< QString::fromStdString(actionBoldColor) <<"}{" << QString::fromStdString(snameS) << "_" << pnumB << "}{.south east}; \n";
-                } else {
-                    t <<  "  \\THit{"<<QString::fromStdString(snameS)<<"_"<< pnumS <<"}{out=40, in=-40, selfhit,"<< QString::fromStdString(actionBoldColor)<<"}{"<<QString::fromStdString(snameT) << "_"<< pnumT << "}{}{"<<QString::fromStdString(snameT)<<"_"<<pnumB<<"} \n";
-                    t <<  " \\path[bounce, bend left] \\TBounce{" << QString::fromStdString(snameS) << "_" << pnumS << "}{"<< QString::fromStdString(actionBoldColor) <<"}{" << QString::fromStdString(snameS) << "_" << pnumB << "}{.north east}; \n";
-                }
+        if(source == target && pnumS==pnumT) {
+            if (pnumS < pnumB) {
+                t <<  "  \\THit{"<<snameS<<"_"<< pnumS  <<"}{out=-40, in=40, selfhit,"<< actionBoldColor<<"}{"<<snameT << "_"<< pnumT << "}{}{"<<snameT<<"_"<<pnumB<<"} \n";
+                t <<  " \\path[bounce, bend right] \\TBounce{" << snameS << "_" << pnumS << "}{"<< actionBoldColor <<"}{" << snameS << "_" << pnumB << "}{.south east}; \n";
             } else {
-                t <<  "   \\THit{"<<QString::fromStdString(snameS)<<"_"<< pnumS <<"}{"<< QString::fromStdString(actionBoldColor) <<"}{"<<QString::fromStdString(snameT) << "_" << pnumT << "}{." << QString::fromStdString(direction) << "}{"<<QString::fromStdString(snameT)<<"_"<<pnumB<<"}\n";
-                t <<  "    \\path[bounce, bend "<< QString::fromStdString(sensAction) <<"] \\TBounce{"<<QString::fromStdString(snameT)<<"_"<< pnumT<<"}{"<< QString::fromStdString(actionBoldColor) <<"}{"<<QString::fromStdString(snameT)<<"_"<< pnumB<<"}{." << QString::fromStdString(direction) << "};\n";
+                t <<  "  \\THit{"<<snameS<<"_"<< pnumS <<"}{out=40, in=-40, selfhit,"<< actionBoldColor<<"}{"<<snameT << "_"<< pnumT << "}{}{"<<snameT<<"_"<<pnumB<<"} \n";
+                t <<  " \\path[bounce, bend left] \\TBounce{" << snameS << "_" << pnumS << "}{"<< actionBoldColor <<"}{" << snameS << "_" << pnumB << "}{.north east}; \n";
             }
-            // t <<  "    \\path[bounce, bend left] \\TBounce{"<<QString::fromStdString(snameT)<<"_"<< pnumT<<"}{}{"<<QString::fromStdString(snameT)<<"_"<< pnumB<<"}{." << QString::fromStdString(direction) << "};\n";
+        } else {
+            t <<  "   \\THit{"<<snameS<<"_"<< pnumS <<"}{"<< actionBoldColor <<"}{"<<snameT << "_" << pnumT << "}{." << direction << "}{"<<snameT<<"_"<<pnumB<<"}\n";
+            t <<  "    \\path[bounce, bend "<< sensAction <<"] \\TBounce{"<<snameT<<"_"<< pnumT<<"}{"<< actionBoldColor <<"}{"<<snameT<<"_"<< pnumB<<"}{." << direction << "};\n";
         }
     }
 
@@ -547,59 +994,38 @@ void PHIO::exportTikzMetadata(PHPtr ph, QFile &output) {
     t << "\\end{document}";
 }
 
-pair<int,int>PHIO::findOrigin( list <pair <int, int> > txy) {
-
-    pair<int,int> origin;
-    pair<int,int> good;
-    int moyx=0;
-    int moyy=0;
-    int S2=0;
-    int S1=0;
-    int Vx;
-    int Vy;
-
-
-
-    for(pair<int,int> &i : txy) {
-        moyx=moyx+i.first;
-        S2 = S2+i.first*i.first;
-        moyy=moyy+i.second;
-        S1=S1+i.second*i.second;
+QPointF PHIO::findOrigin(const vector<QPointF>& centers) {
+
+    if(centers.empty())
+        return QPointF();
+
+    // the coordinates are truncated to integers, as the means and the variances, so that the origin stays
+    // the one of the previous versions; the sums are on 64 bits, the sums of squares overflow an int on large scenes
+    qint64 sumX=0, sumY=0, sumX2=0, sumY2=0;
+    for(const QPointF &c : centers) {
+        const qint64 x = (int) c.x();
+        const qint64 y = (int) c.y();
+        sumX += x;
+        sumY += y;
+        sumX2 += x*x;
+        sumY2 += y*y;
     }
-
-    moyx=(int)moyx/txy.size();
-    moyy=(int)moyy/txy.size();
-
-    Vx = S2/txy.size()-moyx*moyx;
-    Vy = S1/txy.size()-moyy*moyy;
-
-
-    if(Vx<Vy) {
-        pair<int,int> min=txy.front();
-
-        int dmin=fabs(min.first-moyx);
-        origin=std::make_pair(min.first,min.second);
-
-        for(pair<int,int> &i : txy ) {
-            if (dmin<fabs(i.first-moyx)) {
-                origin= std::make_pair(i.first,i.second);
-                dmin=fabs(i.first-moyx);
-            }
-        }
-    } else {
-        pair<int,int> min=txy.front();
-
-        int dmin=fabs(min.second-moyy);
-        origin=std::make_pair(min.first,min.second);
-
-        for(pair<int,int> &i : txy ) {
-            if (dmin<fabs(i.second-moyy)) {
-                origin= std::make_pair(i.first,i.second);
-                dmin=fabs(i.second-moyy);
-            }
+    const qint64 n = centers.size();
+    const qint64 moyx = sumX/n;
+    const qint64 moyy = sumY/n;
+    const qint64 Vx = sumX2/n - moyx*moyx;
+    const qint64 Vy = sumY2/n - moyy*moyy;
+
+    // the origin is the sort the farthest from the mean along the axis of least variance
+    QPoint origin((int) centers.front().x(), (int) centers.front().y());
+    qint64 dmax = -1;
+    for(const QPointF &c : centers) {
+        const QPoint p((int) c.x(), (int) c.y());
+        qint64 d = Vx<Vy ? qAbs(p.x()-moyx) : qAbs(p.y()-moyy);
+        if (dmax<d) {
+            origin=p;
+            dmax=d;
         }
     }
-//good=std::make_pair(moyx,moyy);
     return origin;
-
 }
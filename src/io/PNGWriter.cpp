@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <csetjmp>
+#include <cmath>
+#include <QFile>
+#include "Exceptions.h"
+#include "PNGWriter.h"
+
+
+// libpng reports errors through a longjmp to the latest setjmp: every method below
+// calls setjmp before any libpng call and turns the jump into an io_error
+PNGWriter::PNGWriter(QString p, int w, int h, qreal dpi) : path(p), file(NULL), png(NULL), info(NULL), width(w), remainingRows(h) {
+
+    file = fopen(QFile::encodeName(path).constData(), "wb");
+    if (file == NULL)
+        throw io_error() << file_info(path.toStdString());
+
+    png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (png != NULL)
+        info = png_create_info_struct(png);
+    if (info == NULL) {
+        png_destroy_write_struct(&png, NULL);
+        fclose(file);
+        throw io_error() << file_info(path.toStdString());
+    }
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(file);
+        throw io_error() << file_info(path.toStdString());
+    }
+
+    png_init_io(png, file);
+    png_set_IHDR(png, info, width, remainingRows, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_uint_32 dotsPerMeter = (png_uint_32) std::lround(dpi / 0.0254);
+    png_set_pHYs(png, info, dotsPerMeter, dotsPerMeter, PNG_RESOLUTION_METER);
+    png_write_info(png, info);
+}
+
+PNGWriter::~PNGWriter() {
+    if (png != NULL)
+        png_destroy_write_struct(&png, &info);
+    if (file != NULL)
+        fclose(file);
+}
+
+void PNGWriter::writeRows(const QImage &band) {
+
+    // PNG_COLOR_TYPE_RGB_ALPHA expects non premultiplied R,G,B,A bytes
+    const QImage rows = band.convertToFormat(QImage::Format_RGBA8888);
+    const int count = std::min(rows.height(), remainingRows);
+
+    if (rows.width() != width)
+        throw io_error() << file_info(path.toStdString());
+
+    if (setjmp(png_jmpbuf(png)))
+        throw io_error() << file_info(path.toStdString());
+
+    for (int y = 0; y < count; y++)
+        png_write_row(png, const_cast<png_bytep>(rows.constScanLine(y)));
+    remainingRows -= count;
+}
+
+void PNGWriter::finish() {
+
+    if (remainingRows != 0)
+        throw io_error() << file_info(path.toStdString());
+
+    if (setjmp(png_jmpbuf(png)))
+        throw io_error() << file_info(path.toStdString());
+
+    png_write_end(png, NULL);
+    png_destroy_write_struct(&png, &info);
+    png = NULL;
+    info = NULL;
+
+    if (fclose(file) != 0) {
+        file = NULL;
+        throw io_error() << file_info(path.toStdString());
+    }
+    file = NULL;
+}
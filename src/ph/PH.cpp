@@ -5,6 +5,19 @@
 #include "PH.h"
 #include "MainWindow.h"
 #include <GVSkeletonGraph.h>
+#include "ForceLayout.h"
+#include "GVLayoutCache.h"
+#include "LayoutStrategy.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QtConcurrent>
+#include <QRectF>
+#include <QVector>
+#include <QtCore/qmath.h>
+#include <algorithm>
 #include <QDebug>
 
 
@@ -29,6 +42,16 @@ void PH::render () {
     scene->drawFromSkeleton();
 }
 
+// trigger the rendering in the Scene, keeping the layout of a previous version of the model
+void PH::render (PHPtr previous) {
+    if (!previous.get() || previous->scene.use_count() == 0) {
+        render();
+        return;
+    }
+    if (scene.use_count() == 0) scene = make_shared<PHScene>(this);
+    scene->drawFromLayout(layoutSkeletonFrom(previous->scene));
+}
+
 // get graphics scene for display
 PHScenePtr PH::getGraphicsScene() {
     if (scene.use_count() == 0)	scene = make_shared<PHScene>(this);
@@ -84,6 +107,15 @@ list<SortPtr> PH::getSorts(void) {
     return res;
 }
 
+// sorts indexed as in the skeleton graph, that is in the order of their names
+vector<SortPtr> PH::skeletonSorts(void) {
+    vector<SortPtr> res;
+    res.reserve(sorts.size());
+    for (auto &s : sorts)
+        res.push_back(s.second);
+    return res;
+}
+
 
 // retrieve all Processes in a std::list
 list<ProcessPtr> PH::getProcesses(void) {
@@ -100,36 +132,412 @@ list<ActionPtr> PH::getActions(void) {
     return actions;
 }
 
+// size in pixels of the node of a sort in the skeleton graph
+int PH::skeletonNodeSize(SortPtr s) {
+    int nbProcess = s->getProcesses().size();
+    return (nbProcess+1)*(GProcess::sizeDefault+2*GSort::marginDefault);
+}
+
+// the whole skeleton graph: the sorts in the order of their names, and the edges between distinct sorts
+// in the order of the actions, each one given in the direction of the first action between its two sorts
+// the edges are deduplicated on the indices of their sorts, so that no name is built nor compared per action
+SkeletonComponent PH::skeleton(void) {
+    SkeletonComponent all;
+    all.sorts = skeletonSorts();
+    QHash<const Sort*, int> index;
+    index.reserve(all.sorts.size());
+    for (int i = 0; i < (int) all.sorts.size(); i++) {
+        index.insert(all.sorts[i].get(), i);
+        all.indices.push_back(i);
+    }
+
+    const quint64 n = all.sorts.size();
+    QSet<quint64> connected;
+    for (ActionPtr &a : actions) {
+        int source = index.value(a->getSource()->getSort().get());
+        int target = index.value(a->getTarget()->getSort().get());
+        if (source == target) continue;
+        quint64 key = std::min(source, target) * n + std::max(source, target);
+        if (connected.contains(key)) continue;
+        connected.insert(key);
+        all.edges.push_back(make_pair(source, target));
+    }
+    return all;
+}
+
 // build the skeleton graph of the ph model
 GVSkeletonGraphPtr PH::createSkeletonGraph(void) {
+    return createSkeletonGraph(skeleton(), "dot");
+}
+
+// build the skeleton graph of a part of the ph model, null if graphviz could not lay it out
+GVSkeletonGraphPtr PH::createSkeletonGraph(const SkeletonComponent& component, const QString& alg) {
     GVSkeletonGraphPtr gSkeleton = make_shared<GVSkeletonGraph>(QString("Skeleton Graph"));
     QString sortName;
-    vector<ProcessPtr> listProcess;
-    int nbProcess;
-    for(auto &e : sorts) {
-        sortName = makeSkeletonNodeName(e.second->getName());
-        listProcess = e.second->getProcesses();
-        nbProcess = listProcess.size();
-        int height = (nbProcess+1)*(GProcess::sizeDefault+2*GSort::marginDefault);
+    vector<Agnode_t*> nodes;
+    nodes.reserve(component.sorts.size());
+    for (int i = 0; i < (int) component.sorts.size(); i++) {
+        const SortPtr &s = component.sorts[i];
+        sortName = makeSkeletonNodeName(s->getName());
+        int height = skeletonNodeSize(s);
         int width = height; // modified to get less "vertical" graphs
-        gSkeleton->addNode(sortName);
-        gSkeleton->setNodeSize(gSkeleton->getNode(sortName),width,height);
-        gSkeleton->setGraphObjectAttributes(gSkeleton->getNode(sortName),"fixedsize","true");
+        gSkeleton->addNode(sortName, component.indices[i]);
+        Agnode_t* node = gSkeleton->getNode(sortName);
+        gSkeleton->setNodeSize(node,width,height);
+        gSkeleton->setGraphObjectAttributes(node,"fixedsize","true");
+        nodes.push_back(node);
     }
 
-    for (ActionPtr &a : actions) {
-        QString sourceName = makeSkeletonNodeName(a->getSource()->getSort()->getName());
-        QString targetName = makeSkeletonNodeName(a->getTarget()->getSort()->getName());
-        if(!gSkeleton->connectionExists(sourceName,targetName)&&(QString::compare(sourceName,targetName)!=0)) {
-            gSkeleton->addEdge(sourceName,targetName);
-        }
+    // the edges are already distinct: they are added by their nodes, with no lookup by name
+    for (auto &e : component.edges) {
+        gSkeleton->addEdge(nodes[e.first], nodes[e.second]);
     }
-    gSkeleton->applyLayout();
+    if (!gSkeleton->applyLayout(alg))
+        return GVSkeletonGraphPtr();
 
 
     return gSkeleton;
 }
 
+// hash of everything the layout of the skeleton graph depends on
+QByteArray PH::skeletonHash(void) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray data;
+    QDataStream d(&data, QIODevice::WriteOnly);
+    d << GVLayoutCache::version << GVSkeletonGraph::sepValue << GVSkeletonGraph::layoutDPI << LayoutStrategy::name(LayoutStrategy::getDefault());
+    SkeletonComponent all = skeleton();
+    d << (quint32) all.sorts.size();
+    for (const SortPtr &s : all.sorts)
+        d << QByteArray::fromStdString(s->getName()) << (qint32) skeletonNodeSize(s);
+    d << (quint32) all.edges.size();
+    for (auto &e : all.edges)
+        d << (qint32) e.first << (qint32) e.second;
+    hash.addData(data);
+    return hash.result();
+}
+
+// layout of the skeleton graph, from the cache if the skeleton has already been laid out
+QList<GVNode> PH::layoutSkeleton(void) {
+    QByteArray key = skeletonHash();
+    QList<GVNode> nodes;
+    if (!GVLayoutCache::find(key, nodes)) {
+        nodes = layoutComponents();
+        GVLayoutCache::insert(key, nodes);
+    }
+    return nodes;
+}
+
+// connected components of the skeleton graph, each one holding its sorts and its edges in the order of the model
+vector<SkeletonComponent> PH::skeletonComponents(void) {
+    SkeletonComponent all = skeleton();
+
+    // union-find over the sorts
+    vector<int> parent(all.sorts.size());
+    for (int i = 0; i < (int) parent.size(); i++)
+        parent[i] = i;
+    auto root = [&parent](int i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    for (auto &e : all.edges) {
+        int a = root(e.first), b = root(e.second);
+        if (a != b)
+            parent[std::max(a, b)] = std::min(a, b);
+    }
+
+    // the sorts and edges are renumbered within their component
+    vector<SkeletonComponent> components;
+    vector<int> componentOf(all.sorts.size(), -1);
+    vector<int> local(all.sorts.size());
+    for (int i = 0; i < (int) all.sorts.size(); i++) {
+        int r = root(i);
+        if (componentOf[r] < 0) {
+            componentOf[r] = components.size();
+            components.push_back(SkeletonComponent());
+        }
+        SkeletonComponent &c = components[componentOf[r]];
+        local[i] = c.sorts.size();
+        c.sorts.push_back(all.sorts[i]);
+        c.indices.push_back(i);
+    }
+    for (auto &e : all.edges)
+        components[componentOf[root(e.first)]].edges.push_back(make_pair(local[e.first], local[e.second]));
+    return components;
+}
+
+// layout of a connected component, by dot or by ForceLayout if it is too large
+QList<GVNode> PH::layoutComponent(const SkeletonComponent& component) {
+    if (component.sorts.size() == 1) {
+        GVNode node;
+        node.name = makeSkeletonNodeName(component.sorts.front()->getName());
+        node.index = component.indices.front();
+        node.width = node.height = skeletonNodeSize(component.sorts.front());
+        node.centerPos = QPoint(node.width/2, node.height/2);
+        return QList<GVNode>() << node;
+    }
+
+    const int nodeCount = component.sorts.size();
+    const int edgeCount = component.edges.size();
+    LayoutStrategy::Algorithm algorithm = component.algorithm != LayoutStrategy::Auto ? component.algorithm
+                                                                                      : LayoutStrategy::choose(nodeCount, edgeCount);
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<GVNode> nodes;
+    if (algorithm != LayoutStrategy::Force) {
+        GVSkeletonGraphPtr gSkeleton = createSkeletonGraph(component, LayoutStrategy::name(algorithm));
+        // the graphviz engine may not be installed
+        if (gSkeleton.get())
+            nodes = gSkeleton->nodes();
+        else {
+            // the time of the failed attempt is not recorded as time of the fallback
+            algorithm = LayoutStrategy::Force;
+            timer.restart();
+        }
+    }
+    if (algorithm == LayoutStrategy::Force)
+        nodes = forceLayoutSkeleton(component);
+
+    LayoutStrategy::record(algorithm, nodeCount, edgeCount, timer.elapsed());
+    return nodes;
+}
+
+namespace {
+
+// places the laid out components side by side, in rows of decreasing height (shelf packing)
+QList<GVNode> packComponents(const vector<SkeletonComponent>& components) {
+    const qreal sep = GVSkeletonGraph::sepValue;
+
+    vector<QRectF> bounds;
+    qreal area = 0, widest = 0;
+    for (const SkeletonComponent& c : components) {
+        QRectF b;
+        for (const GVNode& n : c.nodes)
+            b |= QRectF(n.centerPos.x() - n.width/2, n.centerPos.y() - n.height/2, n.width, n.height);
+        bounds.push_back(b);
+        area += (b.width() + sep) * (b.height() + sep);
+        widest = std::max(widest, b.width());
+    }
+
+    vector<int> order(components.size());
+    for (int i = 0; i < (int) order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&bounds](int a, int b) {
+        return bounds[a].height() > bounds[b].height();
+    });
+
+    // rows about as wide as the square of the same area as the components
+    const qreal rowWidth = std::max(widest, qSqrt(area));
+    qreal x = 0, y = 0, rowHeight = 0;
+    QList<GVNode> nodes;
+    for (int i : order) {
+        const QRectF& b = bounds[i];
+        if (x > 0 && x + b.width() > rowWidth) {
+            y += rowHeight + sep;
+            x = 0;
+            rowHeight = 0;
+        }
+        QPoint offset = (QPointF(x, y) - b.topLeft()).toPoint();
+        for (GVNode n : components[i].nodes) {
+            n.centerPos += offset;
+            nodes << n;
+        }
+        x += b.width() + sep;
+        rowHeight = std::max(rowHeight, b.height());
+    }
+    return nodes;
+}
+
+}
+
+// layout of the skeleton graph: the ForceLayout components on the threads of the pool, the graphviz ones,
+// which would only wait for one another on GVLayoutService::Lock there, one after the other on this thread
+QList<GVNode> PH::layoutComponents(void) {
+    vector<SkeletonComponent> components = skeletonComponents();
+    if (components.size() == 1)
+        return layoutComponent(components.front());
+
+    vector<SkeletonComponent*> forced, graphviz;
+    for (SkeletonComponent& c : components) {
+        if (c.sorts.size() > 1)
+            c.algorithm = LayoutStrategy::choose(c.sorts.size(), c.edges.size());
+        if (c.sorts.size() == 1 || c.algorithm == LayoutStrategy::Force)
+            forced.push_back(&c);
+        else
+            graphviz.push_back(&c);
+    }
+
+    QFuture<void> parallel = QtConcurrent::map(forced, [this](SkeletonComponent* c) {
+        c->nodes = layoutComponent(*c);
+    });
+    // the pool works on the components of this frame, it is waited for whatever happens here
+    try {
+        for (SkeletonComponent* c : graphviz)
+            c->nodes = layoutComponent(*c);
+    } catch (...) {
+        parallel.waitForFinished();
+        throw;
+    }
+    parallel.waitForFinished();
+    return packComponents(components);
+}
+
+// layout of a part of the skeleton graph by ForceLayout
+QList<GVNode> PH::forceLayoutSkeleton(const SkeletonComponent& component) {
+    LayoutGraph graph;
+    for (const SortPtr &s : component.sorts)
+        graph.sizes.push_back(skeletonNodeSize(s));
+    graph.edges = component.edges;
+
+    vector<QPointF> centers = ForceLayout(graph, GVSkeletonGraph::sepValue).run();
+
+    QList<GVNode> nodes;
+    for (int i = 0; i < (int) component.sorts.size(); i++) {
+        GVNode node;
+        node.name = makeSkeletonNodeName(component.sorts[i]->getName());
+        node.index = component.indices[i];
+        node.centerPos = centers[i].toPoint();
+        node.width = node.height = graph.sizes[i];
+        nodes << node;
+    }
+    return nodes;
+}
+
+namespace {
+
+// rectangles of the nodes already placed, bucketed in square cells for the lookup of free spots
+class OccupancyGrid {
+
+  public:
+    OccupancyGrid(qreal cellSize) : cell(cellSize) {}
+
+    void add(const QRectF& r) {
+        for (int i = qFloor(r.left()/cell); i <= qFloor(r.right()/cell); i++)
+            for (int j = qFloor(r.top()/cell); j <= qFloor(r.bottom()/cell); j++)
+                cells[key(i, j)].push_back(r);
+        bounds = bounds.isNull() ? r : bounds.united(r);
+    }
+
+    bool isFree(const QRectF& r) const {
+        for (int i = qFloor(r.left()/cell); i <= qFloor(r.right()/cell); i++)
+            for (int j = qFloor(r.top()/cell); j <= qFloor(r.bottom()/cell); j++) {
+                QHash<quint64, QVector<QRectF> >::const_iterator c = cells.find(key(i, j));
+                if (c == cells.end()) continue;
+                for (const QRectF& o : *c)
+                    if (o.intersects(r)) return false;
+            }
+        return true;
+    }
+
+    // the free spot for a rectangle of the given size the nearest to the given center,
+    // looked for on square rings of increasing size around it
+    QPointF freeSpot(const QPointF& center, qreal size) const {
+        const qreal step = size/2;
+        for (int ring = 0; ; ring++) {
+            for (int i = -ring; i <= ring; i++)
+                for (int j = -ring; j <= ring; j++) {
+                    if (qAbs(i) != ring && qAbs(j) != ring) continue;
+                    QPointF c = center + QPointF(i*step, j*step);
+                    if (isFree(QRectF(c.x() - size/2, c.y() - size/2, size, size)))
+                        return c;
+                }
+        }
+    }
+
+    QRectF bounds;
+
+  private:
+    static quint64 key(int i, int j) {
+        return ((quint64) (quint32) i << 32) | (quint32) j;
+    }
+
+    qreal cell;
+    QHash<quint64, QVector<QRectF> > cells;
+};
+
+}
+
+// layout of the skeleton graph keeping the positions of the sorts of a previous scene
+QList<GVNode> PH::layoutSkeletonFrom(PHScenePtr previous) {
+
+    // sorts that were already drawn keep their place
+    SkeletonComponent all = skeleton();
+    const int n = all.sorts.size();
+    map<string, GSortPtr> previousSorts = previous->getGSorts();
+    vector<QPointF> centers(n);
+    vector<bool> placed(n, false);
+    vector<int> added;
+    OccupancyGrid grid(4*(GProcess::sizeDefault+2*GSort::marginDefault));
+    for (int i = 0; i < n; i++) {
+        map<string, GSortPtr>::iterator p = previousSorts.find(all.sorts[i]->getName());
+        if (p == previousSorts.end()) {
+            added.push_back(i);
+            continue;
+        }
+        QPointF c = p->second->getCenterPoint();
+        qreal size = skeletonNodeSize(all.sorts[i]) + GVSkeletonGraph::sepValue;
+        centers[i] = c;
+        placed[i] = true;
+        grid.add(QRectF(c.x() - size/2, c.y() - size/2, size, size));
+    }
+
+    // nothing to keep: the skeleton is laid out as a whole
+    if ((int) added.size() == n)
+        return layoutSkeleton();
+
+    // new sorts are placed, one after the other, at the free spot the nearest to their neighbours already placed;
+    // the ones with no such neighbour are put on the right of the graph
+    if (!added.empty()) {
+        vector<vector<int> > neighbours(n);
+        for (auto &e : all.edges) {
+            neighbours[e.first].push_back(e.second);
+            neighbours[e.second].push_back(e.first);
+        }
+
+        bool progress = true;
+        while (!added.empty()) {
+            vector<int> remaining;
+            for (int i : added) {
+                QPointF sum;
+                int count = 0;
+                for (int j : neighbours[i]) {
+                    if (!placed[j]) continue;
+                    sum += centers[j];
+                    count++;
+                }
+                qreal size = skeletonNodeSize(all.sorts[i]) + GVSkeletonGraph::sepValue;
+                QPointF start;
+                if (count > 0)
+                    start = sum / count;
+                else if (!progress)
+                    start = QPointF(grid.bounds.right() + size/2, grid.bounds.top() + size/2);
+                else {
+                    remaining.push_back(i);
+                    continue;
+                }
+                QPointF c = grid.freeSpot(start, size);
+                centers[i] = c;
+                placed[i] = true;
+                grid.add(QRectF(c.x() - size/2, c.y() - size/2, size, size));
+            }
+            progress = remaining.size() < added.size();
+            added.swap(remaining);
+        }
+    }
+
+    QList<GVNode> nodes;
+    for (int i = 0; i < n; i++) {
+        GVNode node;
+        node.name = makeSkeletonNodeName(all.sorts[i]->getName());
+        node.index = all.indices[i];
+        node.centerPos = centers[i].toPoint();
+        node.width = node.height = skeletonNodeSize(all.sorts[i]);
+        nodes << node;
+    }
+    return nodes;
+}
+
 // output for DOT file
 string PH::toDotString (void) {
 
@@ -1,10 +1,42 @@
+#include <map>
 #include <string>
+#include <QTemporaryFile>
 #include "PHIOTest.h"
 #include "PHIO.h"
+#include "Area.h"
+#include "Exceptions.h"
 
+using std::map;
 using std::string;
 
 
+namespace {
+
+// a tab showing a PH file, as MainWindow opens it
+Area* openArea(const QString& file) {
+    Area* area = new Area(0, file);
+    PHPtr ph = PHIO::parseFile(file.toStdString());
+    area->myArea->setPHPtr(ph);
+    ph->render();
+    area->myArea->setScene(&*ph->getGraphicsScene());
+    area->treeArea->myPHPtr = ph;
+    area->treeArea->myArea = area->myArea;
+    area->treeArea->build();
+    return area;
+}
+
+// the layout of a tab, as written by exportBinaryLayout
+QByteArray exportedLayout(Area* area) {
+    QTemporaryFile file;
+    if (!file.open()) return QByteArray();
+    PHIO::exportBinaryLayout(area, file);
+    file.seek(0);
+    return file.readAll();
+}
+
+}
+
+
 // test parser on various operations
 void PHIOTest::parse_data()  {
     QTest::addColumn<QString>("source");
@@ -27,3 +59,69 @@ void PHIOTest::parse()  {
     QFETCH(QString, source);
     QVERIFY(PHIO::canParseFile(source.toStdString()));
 }
+
+
+// a layout saved from a tab is restored as is in another tab showing the same model
+void PHIOTest::binaryLayout() {
+    QScopedPointer<Area> saved(openArea("tests/3_actions.ph"));
+    PHScenePtr savedScene = saved->myArea->getPHPtr()->getGraphicsScene();
+    map<string, GSortPtr> savedSorts = savedScene->getGSorts();
+    QVERIFY(savedSorts.size() >= 2);
+
+    GSortPtr first = savedSorts.begin()->second;
+    GSortPtr last = savedSorts.rbegin()->second;
+    first->moveTo(*first->getLeftTopCornerPoint() + QPointF(500, -250));
+    first->getRect()->setBrush(QBrush(QColor(12, 34, 56)));
+    first->toBold();
+    last->setVertical(false);
+    last->actionsHide();
+    savedScene->setBackgroundBrush(QColor(31, 31, 31));
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    PHIO::exportBinaryLayout(saved.data(), file);
+    file.seek(0);
+
+    QScopedPointer<Area> restored(openArea("tests/3_actions.ph"));
+    PHIO::importBinaryLayout(restored.data(), file);
+    PHScenePtr restoredScene = restored->myArea->getPHPtr()->getGraphicsScene();
+
+    QCOMPARE(restoredScene->backgroundBrush().color(), savedScene->backgroundBrush().color());
+    for (auto &s : savedSorts) {
+        GSortPtr r = restoredScene->getGSort(s.first);
+        QCOMPARE(*r->getLeftTopCornerPoint(), *s.second->getLeftTopCornerPoint());
+        QCOMPARE(r->getRect()->brush().color(), s.second->getRect()->brush().color());
+        QCOMPARE(r->isBold(), s.second->isBold());
+        QCOMPARE(r->isVertical(), s.second->isVertical());
+        QCOMPARE(r->GSort::isVisible(), s.second->GSort::isVisible());
+    }
+}
+
+
+// truncated or corrupted layout files are rejected
+void PHIOTest::binaryLayoutRejected() {
+    QScopedPointer<Area> area(openArea("tests/3_actions.ph"));
+    const QByteArray layout = exportedLayout(area.data());
+    QVERIFY(layout.size() > 28);
+
+    QList<QByteArray> wrongs;
+    // truncated: in the header, then by one byte
+    wrongs << layout.left(10) << layout.left(layout.size() - 1);
+    // wrong magic number
+    QByteArray magic(layout);
+    magic[0] = 'X';
+    wrongs << magic;
+    // sort count (after magic, byte order, version and flags) that does not match the size of the file
+    QByteArray count(layout);
+    const quint32 tooMany = 0xFFFFFFFF;
+    count.replace(12, sizeof(tooMany), reinterpret_cast<const char*>(&tooMany), sizeof(tooMany));
+    wrongs << count;
+
+    for (const QByteArray& wrong : wrongs) {
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        file.write(wrong);
+        file.seek(0);
+        QVERIFY_EXCEPTION_THROWN(PHIO::importBinaryLayout(area.data(), file), wrong_layout_format);
+    }
+}
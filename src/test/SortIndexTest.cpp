@@ -0,0 +1,129 @@
+#include <boost/make_shared.hpp>
+#include "SortIndexTest.h"
+#include "SortIndex.h"
+#include "GSort.h"
+#include "PHScene.h"
+
+using boost::make_shared;
+
+
+namespace {
+
+// a sort of 40x40 pixels centered on a point, not indexed by its scene
+GSortPtr makeGSort(const std::string& name, PHScene* scene, int x, int y) {
+    GVNode node;
+    node.centerPos = QPoint(x, y);
+    return make_shared<GSort>(Sort::make(name, 1), node, 40, 40, scene);
+}
+
+}
+
+
+// the sorts found in a rectangle are the ones closer to it than the padding
+void SortIndexTest::inRect() {
+    PHScene scene(0);
+    GSortPtr a = makeGSort("a", &scene, 100, 100);
+    GSortPtr b = makeGSort("b", &scene, 1000, 1000);
+    SortIndex index;
+    index.insert(a.get());
+    index.insert(b.get());
+
+    QVector<GSort*> found = index.inRect(QRectF(0, 0, 200, 200));
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found.front(), a.get());
+
+    // a spans 80 to 120: 10 pixels away is within the padding, 30 pixels away is not
+    QVERIFY(index.inRect(QRectF(130, 90, 10, 10)).contains(a.get()));
+    QVERIFY(index.inRect(QRectF(150, 90, 10, 10)).isEmpty());
+    QCOMPARE(index.inRect(QRectF(0, 0, 2000, 2000)).size(), 2);
+}
+
+
+// the sorts along a segment are found walking the cells it crosses
+void SortIndexTest::alongLine() {
+    PHScene scene(0);
+    GSortPtr a = makeGSort("a", &scene, 100, 100);
+    GSortPtr b = makeGSort("b", &scene, 1000, 1000);
+    GSortPtr c = makeGSort("c", &scene, 100, 1000);
+    SortIndex index;
+    index.insert(a.get());
+    index.insert(b.get());
+    index.insert(c.get());
+
+    QVector<GSort*> horizontal = index.alongLine(QLineF(0, 100, 2000, 100));
+    QVERIFY(horizontal.contains(a.get()));
+    QVERIFY(!horizontal.contains(b.get()));
+    QVERIFY(!horizontal.contains(c.get()));
+
+    QVector<GSort*> diagonal = index.alongLine(QLineF(0, 0, 1100, 1100));
+    QVERIFY(diagonal.contains(a.get()));
+    QVERIFY(diagonal.contains(b.get()));
+    QVERIFY(!diagonal.contains(c.get()));
+
+    // walked backwards, and with no length
+    QVERIFY(index.alongLine(QLineF(1100, 1100, 0, 0)).contains(a.get()));
+    QVERIFY(index.alongLine(QLineF(100, 1000, 100, 1000)).contains(c.get()));
+}
+
+
+// a sort moved to other cells is found in its new cells only
+void SortIndexTest::update() {
+    PHScene scene(0);
+    GSortPtr a = makeGSort("a", &scene, 100, 100);
+    SortIndex index;
+    index.insert(a.get());
+
+    a->moveTo(QPointF(1480, 80));
+    index.update(a.get());
+    QVERIFY(index.inRect(QRectF(0, 0, 200, 200)).isEmpty());
+    QVERIFY(index.inRect(QRectF(1400, 0, 200, 200)).contains(a.get()));
+    QCOMPARE(index.rect(a.get()), a->getSceneRect().adjusted(-SortIndex::padding, -SortIndex::padding,
+                                                            SortIndex::padding, SortIndex::padding));
+
+    // a small move within the same cells
+    a->moveTo(QPointF(1490, 90));
+    index.update(a.get());
+    QVERIFY(index.inRect(QRectF(1520, 90, 10, 10)).contains(a.get()));
+
+    index.remove(a.get());
+    QVERIFY(index.inRect(QRectF(1400, 0, 200, 200)).isEmpty());
+    QVERIFY(index.rect(a.get()).isNull());
+}
+
+
+// a rectangle is free if it is farther than the padding from all the other sorts
+void SortIndexTest::isFree() {
+    PHScene scene(0);
+    GSortPtr a = makeGSort("a", &scene, 100, 100);
+    SortIndex index;
+    index.insert(a.get());
+
+    QVERIFY(index.isFree(QRectF(500, 500, 40, 40)));
+    QVERIFY(!index.isFree(QRectF(130, 80, 40, 40)));
+    QVERIFY(index.isFree(QRectF(150, 80, 40, 40)));
+    QVERIFY(index.isFree(a->getSceneRect(), a.get()));
+    QVERIFY(!index.isFree(a->getSceneRect()));
+}
+
+
+// the free spot of a rectangle is the nearest free position around it, within the rings looked at
+void SortIndexTest::freeSpot() {
+    PHScene scene(0);
+    GSortPtr a = makeGSort("a", &scene, 100, 100);
+    SortIndex index;
+    index.insert(a.get());
+
+    // already free: not moved
+    QCOMPARE(index.freeSpot(QRectF(500, 500, 40, 40)), QRectF(500, 500, 40, 40));
+
+    const QRectF over(90, 90, 40, 40);
+    QRectF spot = index.freeSpot(over);
+    QVERIFY(!spot.isNull());
+    QVERIFY(index.isFree(spot));
+    QCOMPARE(spot.size(), over.size());
+    QVERIFY(qAbs(spot.left() - over.left()) <= SortIndex::maxRings * SortIndex::padding);
+    QVERIFY(qAbs(spot.top() - over.top()) <= SortIndex::maxRings * SortIndex::padding);
+
+    // no ring around: no free spot
+    QVERIFY(index.freeSpot(over, 0, 0).isNull());
+}
@@ -1,5 +1,7 @@
+#include <QApplication>
 #include <QtTest/QtTest>
 #include "PHIOTest.h"
+#include "SortIndexTest.h"
 
 /**
  * @file TestRunner.cpp
@@ -7,7 +9,12 @@
  */
 
 int main (int argc, char ** argv) {
+    // the layout tests open tabs: widgets need an application
+    QApplication app(argc, argv);
+    int status = 0;
     PHIOTest test1;
-    QTest::qExec(&test1);
-    return 0;
+    status |= QTest::qExec(&test1, argc, argv);
+    SortIndexTest test2;
+    status |= QTest::qExec(&test2, argc, argv);
+    return status;
 }
@@ -289,7 +289,6 @@ void Area::saveEdit(int del) {
     flux.setCodec("UTF-8");
 
     QString *file = new QString("temp.ph");
-    QString fileXML("tempXML.xml");
     std::string phFile = file->toStdString();
 
     try {
@@ -309,16 +308,14 @@ void Area::saveEdit(int del) {
             emit makeTempXML();
         }
 
-        /*TODO understand why importXMLMetadata after rendering makes actions mad when updating text area... Bug in updating actions ?
-        Is it useful to call that method here ? */
-        this->mainWindow->importXMLMetadata(fileXML);
-
-        // render graph
+        // render graph, the sorts that were already there keeping their place
+        PHPtr previousPHPtr = this->myArea->getPHPtr();
         PHPtr myPHPtr = PHIO::parseFile(phFile);
         this->myArea->setPHPtr(myPHPtr);
-        myPHPtr->render();
+        myPHPtr->render(previousPHPtr);
         PHScenePtr scene = myPHPtr->getGraphicsScene();
         this->myArea->setScene(&*scene);
+        this->myArea->updateViewport();
 
         // delete the current sortsTree and groupsTree
         this->treeArea->sortsTree->clear();
@@ -329,6 +326,16 @@ void Area::saveEdit(int del) {
         // build the tree in the treeArea
         this->treeArea->build();
 
+        // restore the layout saved before edition
+        if(this->tempLayout.exists() && this->tempLayout.open(QIODevice::ReadOnly)) {
+            try {
+                PHIO::importBinaryLayout(this, this->tempLayout);
+            } catch(wrong_layout_format&) {
+                QMessageBox::warning(this, "Warning", "The layout could not be restored after update.");
+            }
+            this->tempLayout.close();
+        }
+
         this->indicatorEdit->setVisible(false);
         this->saveTextEdit->setDefault(false);
         this->textArea->incrementeNberTextChange();
@@ -430,13 +437,13 @@ void Area::hideToolTip() {
 
 void Area::tempXMLfile() {
 
-    this->tempXML.setFileName("tempXML.xml");
-    this->tempXML.open(QIODevice::WriteOnly);
-    PHIO::exportXMLMetadata(this->mainWindow, this->tempXML);
-    this->tempXML.close();
+    this->tempLayout.setFileName("tempLayout.gphl");
+    this->tempLayout.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    PHIO::exportBinaryLayout(this, this->tempLayout);
+    this->tempLayout.close();
 }
 
 void Area::deleteTempXML() {
 
-    this->tempXML.remove();
+    this->tempLayout.remove();
 }
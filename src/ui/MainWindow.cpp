@@ -54,6 +54,8 @@ MainWindow::MainWindow() {
     actionSaveas = menuFile->addAction("Save as...");
     menuExport = menuFile->addMenu("Export");
     actionPng = menuExport->addAction("PNG graph");
+    actionSvg = menuExport->addAction("SVG graph");
+    actionPdf = menuExport->addAction("PDF graph");
     actionDot = menuExport->addAction("DOT graph");
     actionExportXMLData = menuExport->addAction("Style and Layout");
     actionExportTikzData = menuExport->addAction("Generate Tikz File");
@@ -81,6 +83,8 @@ MainWindow::MainWindow() {
     QObject::connect(actionOpen,    SIGNAL(triggered()), this, SLOT(openTab()));
     QObject::connect(actionSaveas,  SIGNAL(triggered()), this, SLOT(save()));
     QObject::connect(actionPng,     SIGNAL(triggered()), this, SLOT(exportPng()));
+    QObject::connect(actionSvg,     SIGNAL(triggered()), this, SLOT(exportSvg()));
+    QObject::connect(actionPdf,     SIGNAL(triggered()), this, SLOT(exportPdf()));
     QObject::connect(actionClose,   SIGNAL(triggered()), this, SLOT(closeTab()));
     QObject::connect(actionExportXMLData, SIGNAL(triggered()), this, SLOT(exportXMLMetadata()));
     QObject::connect(actionDot, SIGNAL(triggered()), this, SLOT(exportDot()));
@@ -197,6 +201,8 @@ MainWindow::MainWindow() {
         this->actionClose->setEnabled(false);
         this->actionSaveas->setEnabled(false);
         this->actionPng->setEnabled(false);
+        this->actionSvg->setEnabled(false);
+        this->actionPdf->setEnabled(false);
         this->actionDot->setEnabled(false);
         this->actionExportXMLData->setEnabled(false);
         this->actionExportTikzData->setEnabled(false);
@@ -308,6 +314,7 @@ MyArea* MainWindow::openTab() {
                 myPHPtr->render();
                 PHScenePtr scene = myPHPtr->getGraphicsScene();
                 area->myArea->setScene(&*scene);
+                area->myArea->updateViewport();
 
                 // set the pointer of the treeArea
                 area->treeArea->myPHPtr = myPHPtr;
@@ -433,12 +440,70 @@ void MainWindow::exportPng() {
 
         // SaveFile dialog
         QString fichier = QFileDialog::getSaveFileName(this, "Export as .png file", QString(), "*.png");
+        if (fichier.isEmpty()) return;
+
+        // resolution of the image
+        bool ok;
+        int dpi = QInputDialog::getInt(this, "Export as .png file", "Resolution (dpi) : ", PHIO::screenDPI, 24, 2400, 1, &ok);
+        if (!ok) return;
 
         // need the PHPtr which is associated with the subwindow
         PHPtr ph= ((Area*) subWindow->widget())->myArea->getPHPtr();
 
         // save as PNG
-        PHIO::exportToPNG(ph, fichier);
+        try {
+            PHIO::exportToPNG(ph, fichier, dpi);
+        } catch(io_error&) {
+            QMessageBox::critical(this, "Error", "Sorry, unable to write the image.");
+        }
+
+    } else QMessageBox::critical(this, "Error", "No file opened!");
+
+}
+
+void MainWindow::exportSvg() {
+
+    if(!this->getCentraleArea()->subWindowList().isEmpty()) {
+        // get the current subwindow
+        QMdiSubWindow *subWindow = this->getCentraleArea()->currentSubWindow();
+
+        // SaveFile dialog
+        QString fichier = QFileDialog::getSaveFileName(this, "Export as .svg file", QString(), "*.svg");
+        if (fichier.isEmpty()) return;
+
+        // need the PHPtr which is associated with the subwindow
+        PHPtr ph= ((Area*) subWindow->widget())->myArea->getPHPtr();
+
+        // save as SVG
+        try {
+            PHIO::exportToSVG(ph, fichier);
+        } catch(io_error&) {
+            QMessageBox::critical(this, "Error", "Sorry, unable to write the file.");
+        }
+
+    } else QMessageBox::critical(this, "Error", "No file opened!");
+
+}
+
+void MainWindow::exportPdf() {
+
+    if(!this->getCentraleArea()->subWindowList().isEmpty()) {
+        // get the current subwindow
+        QMdiSubWindow *subWindow = this->getCentraleArea()->currentSubWindow();
+
+        // SaveFile dialog
+        QString fichier = QFileDialog::getSaveFileName(this, "Export as .pdf file", QString(), "*.pdf");
+        if (fichier.isEmpty()) return;
+
+        // need the PHPtr which is associated with the subwindow
+        PHPtr ph= ((Area*) subWindow->widget())->myArea->getPHPtr();
+
+        // save as PDF
+        try {
+            PHIO::exportToPDF(ph, fichier);
+        } catch(io_error&) {
+            QMessageBox::critical(this, "Error", "Sorry, unable to write the file.");
+        }
 
     } else QMessageBox::critical(this, "Error", "No file opened!");
 
@@ -627,6 +692,9 @@ void MainWindow::importXMLMetadata(QString tempXML) {
                             // Setting the y coordinate to the new value
                             myarea->getPHPtr()->getGraphicsScene()->getGSort(sortname)->getLeftTopCornerPoint()->setY(posyCluster);
 
+                            // the spatial index follows the sort, for the overlap checks, the routing of the hits and the culling
+                            myarea->getPHPtr()->getGraphicsScene()->getSortIndex().update(myarea->getPHPtr()->getGraphicsScene()->getGSort(sortname).get());
+
                             stream.readNext();
                             while (stream.isStartElement()==false) {
                                 stream.readNext();
@@ -834,7 +902,8 @@ void MainWindow::adjust() {
     // get the widget in the centrale area
     Area* view = (Area*) this->getCentraleArea()->currentSubWindow()->widget();
     // get the myArea (middle) part and fit the view
-    view->myArea->fitInView(view->myArea->scene()->itemsBoundingRect(), Qt::KeepAspectRatio);
+    view->myArea->fitInView(view->myArea->getPHPtr()->getGraphicsScene()->getModelRect(), Qt::KeepAspectRatio);
+    view->myArea->updateViewport();
 }
 
 // method to zoom In
@@ -941,8 +1010,8 @@ void MainWindow::positiveContrast() {
     std::vector<GProcessPtr> processes = view->myArea->getPHPtr()->getGraphicsScene()->getProcesses();
     // set the color ellipse to transparent
     for (GProcessPtr &a: processes) {
-        a->getEllipseItem()->setPen(QPen(Qt::black, 1));
-        a->getEllipseItem()->setBrush(QBrush(QColor(220,220,220)));
+        a->setEllipsePen(QPen(Qt::black, 1));
+        a->setEllipseBrush(QBrush(QColor(220,220,220)));
     }
 }
 
@@ -967,8 +1036,8 @@ void MainWindow::negativeContrast() {
     std::vector<GProcessPtr> processes = view->myArea->getPHPtr()->getGraphicsScene()->getProcesses();
     // set the color ellipse to transparent
     for (GProcessPtr &a: processes) {
-        a->getEllipseItem()->setPen(QPen(Qt::black, 1));
-        a->getEllipseItem()->setBrush(QBrush(QColor(160,160,160)));
+        a->setEllipsePen(QPen(Qt::black, 1));
+        a->setEllipseBrush(QBrush(QColor(160,160,160)));
     }
 }
 
@@ -994,8 +1063,8 @@ void MainWindow::printStyle() {
     std::vector<GProcessPtr> processes = view->myArea->getPHPtr()->getGraphicsScene()->getProcesses();
     // set the color ellipse to transparent
     for (GProcessPtr &a: processes) {
-        a->getEllipseItem()->setPen(QPen(Qt::black, 3));
-        a->getEllipseItem()->setBrush(Qt::NoBrush);
+        a->setEllipsePen(QPen(Qt::black, 3));
+        a->setEllipseBrush(Qt::NoBrush);
     }
 }
 
@@ -1266,6 +1335,8 @@ void MainWindow::disableMenu(QMdiSubWindow* subwindow) {
         this->actionClose->setEnabled(false);
         this->actionSaveas->setEnabled(false);
         this->actionPng->setEnabled(false);
+        this->actionSvg->setEnabled(false);
+        this->actionPdf->setEnabled(false);
         this->actionDot->setEnabled(false);
         this->actionExportXMLData->setEnabled(false);
         //change to false after that
@@ -1299,6 +1370,8 @@ void MainWindow::enableMenu() {
         this->actionClose->setEnabled(true);
         this->actionSaveas->setEnabled(true);
         this->actionPng->setEnabled(true);
+        this->actionSvg->setEnabled(true);
+        this->actionPdf->setEnabled(true);
         this->actionDot->setEnabled(true);
         this->actionExportXMLData->setEnabled(true);
         this->actionExportTikzData->setEnabled(true);
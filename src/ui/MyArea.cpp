@@ -1,5 +1,6 @@
 #include <QPainter>
 #include "MyArea.h"
+#include "PHScene.h"
 
 
 // constructor
@@ -49,11 +50,13 @@ void MyArea::wheelEvent(QWheelEvent *event) {
         this->setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
         // scale positively
         this->scale(this->getScalingFactor(), this->getScalingFactor());
+        updateViewport();
     } else if(event->delta()<0 && event->modifiers() == Qt::ControlModifier) {
         // if the delta is negative, the action must follow the center of the view
         this->setTransformationAnchor(QGraphicsView::AnchorViewCenter);
         // scale negatively
         this->scale(1 / this->getScalingFactor(), 1 / this->getScalingFactor());
+        updateViewport();
     } else {
         QGraphicsView::wheelEvent(event);
     }
@@ -63,12 +66,30 @@ void MyArea::wheelEvent(QWheelEvent *event) {
 void MyArea::zoomIn() {
     this->setTransformationAnchor(QGraphicsView::AnchorViewCenter);
     this->scale(this->getScalingFactor(), this->getScalingFactor());
+    updateViewport();
 }
 
 // method to zoom out
 void MyArea::zoomOut() {
     this->setTransformationAnchor(QGraphicsView::AnchorViewCenter);
     this->scale(1 / this->getScalingFactor(), 1 / this->getScalingFactor());
+    updateViewport();
+}
+
+void MyArea::updateViewport() {
+    PHScene* phScene = dynamic_cast<PHScene*>(scene());
+    if (phScene)
+        phScene->setViewport(mapToScene(viewport()->rect()).boundingRect());
+}
+
+void MyArea::scrollContentsBy(int dx, int dy) {
+    QGraphicsView::scrollContentsBy(dx, dy);
+    updateViewport();
+}
+
+void MyArea::resizeEvent(QResizeEvent *event) {
+    QGraphicsView::resizeEvent(event);
+    updateViewport();
 }
 
 
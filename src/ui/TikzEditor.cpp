@@ -158,6 +158,9 @@ void TikzEditor::quit() {
 
 void TikzEditor::back() {
 
+    // the hits are routed again once, after all the sorts are shown or hidden
+    PHScene::BatchUpdate batch(myPHPtr->getGraphicsScene().get());
+
     QList <QTreeWidgetItem*> selectedItems=getSelectedSorts();
     for(QTreeWidgetItem *item:selectedItems) {
         // Show the QGraphicsItem representing the sort
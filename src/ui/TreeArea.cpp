@@ -321,16 +321,8 @@ void TreeArea::hideSort(int clickedTree) {
         }
     }
 
-    // Hide the QGraphicsItem representing the sort
-    this->myPHPtr->getGraphicsScene()->getGSort(text.toStdString())->GSort::hide();
-
-    // Hide all the actions related to the sort
-    std::vector<GActionPtr> allActions = this->myPHPtr->getGraphicsScene()->getActions();
-    for (GActionPtr &a: allActions) {
-        if (a->getAction()->getSource()->getSort()->getName() == text.toStdString() || a->getAction()->getTarget()->getSort()->getName() == text.toStdString() || a->getAction()->getResult()->getSort()->getName() == text.toStdString()) {
-            a->getDisplayItem()->hide();
-        }
-    }
+    // Hide the QGraphicsItem representing the sort, and all the actions related to the sort
+    this->myPHPtr->getGraphicsScene()->getGSort(text.toStdString())->actionsHide();
 }
 
 void TreeArea::showSort(int clickedTree) {
@@ -373,19 +365,8 @@ void TreeArea::showSort(int clickedTree) {
         }
     }
 
-    // Show the QGraphicsItem representing the sort
-    this->myPHPtr->getGraphicsScene()->getGSort(text.toStdString())->GSort::show();
-
-    std::vector<GActionPtr> allActions = this->myPHPtr->getGraphicsScene()->getActions();
-    for (GActionPtr &a: allActions) {
-        if (a->getAction()->getSource()->getSort()->getName() == text.toStdString() || a->getAction()->getTarget()->getSort()->getName() == text.toStdString() || a->getAction()->getResult()->getSort()->getName() == text.toStdString()) {
-            if (       (myPHPtr->getGraphicsScene()->getGSort(a->getAction()->getSource()->getSort()->getName())->GSort::isVisible())
-                       && (myPHPtr->getGraphicsScene()->getGSort(a->getAction()->getTarget()->getSort()->getName())->GSort::isVisible())
-                       && (myPHPtr->getGraphicsScene()->getGSort(a->getAction()->getResult()->getSort()->getName())->GSort::isVisible()) ) {
-                a->getDisplayItem()->show();
-            }
-        }
-    }
+    // Show the QGraphicsItem representing the sort, and the actions related to the sort whose sorts are all visible
+    this->myPHPtr->getGraphicsScene()->getGSort(text.toStdString())->actionsShow();
 
 }
 
@@ -479,22 +460,12 @@ void TreeArea::showGroup() {
     QList<QTreeWidgetItem*> wholeTree = this->groupsTree->findItems("", Qt::MatchContains | Qt::MatchRecursive, 0);
     // Get all the items in the tree whose parent is the current item
     if (item->childCount() != 0) {
+        // the hits are routed again once, after all the sorts of the group are shown
+        PHScene::BatchUpdate batch(this->myPHPtr->getGraphicsScene().get());
         for (QTreeWidgetItem* &a: wholeTree) {
             if (a->parent() == item) {
-                // Show the GraphicsItem
-                this->myPHPtr->getGraphicsScene()->getGSort(a->text(0).toStdString())->GSort::show();
-
-                // Hide all the actions related to the sort
-                std::vector<GActionPtr> allActions = this->myPHPtr->getGraphicsScene()->getActions();
-                for (GActionPtr &b: allActions) {
-                    if (b->getAction()->getSource()->getSort()->getName() == a->text(0).toStdString() || b->getAction()->getTarget()->getSort()->getName() == a->text(0).toStdString() || b->getAction()->getResult()->getSort()->getName() == a->text(0).toStdString()) {
-                        if (       (myPHPtr->getGraphicsScene()->getGSort(b->getAction()->getSource()->getSort()->getName())->GSort::isVisible())
-                                   && (myPHPtr->getGraphicsScene()->getGSort(b->getAction()->getTarget()->getSort()->getName())->GSort::isVisible())
-                                   && (myPHPtr->getGraphicsScene()->getGSort(b->getAction()->getResult()->getSort()->getName())->GSort::isVisible())) {
-                            b->getDisplayItem()->show();
-                        }
-                    }
-                }
+                // Show the GraphicsItem, and the actions related to the sort whose sorts are all visible
+                this->myPHPtr->getGraphicsScene()->getGSort(a->text(0).toStdString())->actionsShow();
 
                 // Set the font to Normal
                 QFont f = a->font(0);
@@ -526,18 +497,12 @@ void TreeArea::hideGroup() {
     QList<QTreeWidgetItem*> wholeTree = this->groupsTree->findItems("", Qt::MatchContains | Qt::MatchRecursive, 0);
     // Get all the items in the tree whose parent is the current item
     if (item->childCount() != 0) {
+        // the hits are routed again once, after all the sorts of the group are hidden
+        PHScene::BatchUpdate batch(this->myPHPtr->getGraphicsScene().get());
         for (QTreeWidgetItem* &a: wholeTree) {
             if (a->parent() == item) {
-                // Hide the GraphicsItem
-                this->myPHPtr->getGraphicsScene()->getGSort(a->text(0).toStdString())->GSort::hide();
-
-                // Hide all the actions related to the sort
-                std::vector<GActionPtr> allActions = this->myPHPtr->getGraphicsScene()->getActions();
-                for (GActionPtr &b: allActions) {
-                    if (b->getAction()->getSource()->getSort()->getName() == a->text(0).toStdString() || b->getAction()->getTarget()->getSort()->getName() == a->text(0).toStdString() || b->getAction()->getResult()->getSort()->getName() == a->text(0).toStdString()) {
-                        b->getDisplayItem()->hide();
-                    }
-                }
+                // Hide the GraphicsItem, and all the actions related to the sort
+                this->myPHPtr->getGraphicsScene()->getGSort(a->text(0).toStdString())->actionsHide();
 
                 // Set the font to Italic
                 QFont f = a->font(0);